@@ -3,209 +3,188 @@
 // Author: María Fernanda Moreno Gómez A01708653
 //         Uri Jared Gopar Morales  A01709413
 // Description: Este archivo contiene el código para un AFD de una expresión regular
-//              To compile: g++ -std=c++17 RegularExpressionToAFD.cpp -o app   y después  ./app
+//              Lee la expresión (primer renglón) y el alfabeto (segundo renglón) de input.txt,
+//              la analiza (expresion.h), construye el AFN de Thompson
+//              (automata.h), lo compila a formato CSR, lo convierte en AFD con la
+//              construcción de subconjuntos y lo minimiza con Hopcroft (afd.h). Imprime los
+//              dos autómatas y el tiempo de cada etapa (la mediana de las repeticiones).
+//              Con --cadena dice si cada cadena pertenece al lenguaje (reconocedor.h). Con
+//              --perezoso no se construye el AFD completo: las cadenas se reconocen con el AFD
+//              perezoso (afd_perezoso.h), que usa a lo más --memoria bytes de caché.
+//              To compile: g++ -std=c++17 -O2 RegularExpressionToAFD.cpp -o app   y después  ./app
+//                          [--entrada ARCHIVO] [--repeticiones N] [--formato texto|json|csv]
+//                          [--cadena TEXTO]... [--perezoso] [--memoria BYTES]
 // ===========================================================================================
 #include <iostream>
 #include <fstream>
-#include <stack>
 #include <string>
 #include <vector>
-#include <set>
-#include <unordered_map>
+#include "../comun/perfilador.h"
+#include "automata.h"
+#include "afd.h"
+#include "reconocedor.h"
+#include "afd_perezoso.h"
 
 using namespace std;
-struct State {
-    unordered_map<char, char> transitions;  // Transiciones del estado
-    bool accepting;  // Indica si el estado es de aceptación
-};
 
-class Automata {
-public:
-    vector<State> states;  // Vector de estados del AFD
-
-    Automata(char c) {
-        states.push_back(State{{}, false});  // Estado inicial
-        states.push_back(State{{}, true});   // Estado de aceptación
-
-        if (c != 'E') {
-            states[0].transitions[c] = 'B';
+int main(int argc, char* argv[]) {
+    string entrada = "input.txt";
+    int repeticiones = 1;
+    FormatoReporte formato = TEXTO;
+    vector<string> cadenas;
+    bool perezoso = false;
+    size_t memoria = 1 << 20;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--entrada" && i + 1 < argc) {
+            entrada = argv[++i];
+        } else if (arg == "--cadena" && i + 1 < argc) {
+            cadenas.push_back(argv[++i]);
+        } else if (arg == "--perezoso") {
+            perezoso = true;
+        } else if (arg == "--memoria" && i + 1 < argc) {
+            memoria = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--repeticiones" && i + 1 < argc) {
+            repeticiones = max(1, atoi(argv[++i]));
+        } else if (arg == "--formato" && i + 1 < argc) {
+            if (!leerFormato(argv[++i], formato)) {
+                cerr << "Formato desconocido: " << argv[i] << endl;
+                return 1;
+            }
         }
     }
 
-    Automata(size_t numStates) : states(numStates) {}
-
-    void addTransition(char from, char to, char c) {
-        states[from - 'A'].transitions[c] = to;
+    ifstream file(entrada);
+    if (!file) {
+        cerr << "No se pudo abrir " << entrada << endl;
+        return 1;
     }
 
-    void printAutomata() {
-        for (size_t i = 0; i < states.size(); i++) {
-            cout << "State " << static_cast<char>(i + 'A') << (states[i].accepting ? " (Accepting)" : "") << ":\n";
-            for (auto& [c, to] : states[i].transitions) {
-                cout << "  --(" << c << ")--> " << to << '\n';
-            }
-        }
+    //Renglones completos: la expresión y el alfabeto pueden tener espacios
+    string regexText, alphabet;
+    getline(file, regexText);
+    getline(file, alphabet);
+    for (string* linea : {&regexText, &alphabet}) {
+        if (!linea->empty() && linea->back() == '\r') linea->pop_back();
     }
-};
-
-Automata concatenateAutomata(const Automata& a, const Automata& b) {
-    Automata result(a.states.size() + b.states.size());
 
-    for (char i = 'A'; i < 'A' + a.states.size(); i++) {
-        for (auto& [c, to] : a.states[i - 'A'].transitions) {
-            result.addTransition(i, to, c);
+    //Cada etapa se mide por separado; la cerradura-ε es parte de la construcción de subconjuntos
+    vector<double> tiemposAnalisis, tiemposAFN, tiemposCSR, tiemposCerradura, tiemposSubconjuntos, tiemposHopcroft;
+    Regex regex;
+    Automata a;
+    NFA nfa;
+    DFA dfa, minimal;
+    for (int r = 0; r < repeticiones; r++) {
+        Cronometro cronometro;
+        string error;
+        size_t posicion;
+        if (!parseRegex(regexText, regex, error, posicion)) {
+            cerr << "Error en la expresion, posicion " << posicion << ": " << error << '\n'
+                 << "  " << regexText << '\n'
+                 << "  " << string(posicion, ' ') << '^' << endl;
+            return 1;
         }
-    }
+        tiemposAnalisis.push_back(cronometro.milisegundos());
 
-    for (char i = 'A'; i < 'A' + b.states.size(); i++) {
-        for (auto& [c, to] : b.states[i - 'A'].transitions) {
-            result.addTransition(i + a.states.size(), to + a.states.size(), c);
-        }
-    }
+        cronometro.reiniciar();
+        a = constructAutomata(regex);
+        tiemposAFN.push_back(cronometro.milisegundos());
 
-    result.states[a.states.size() - 1].accepting = false;
-    result.addTransition(a.states.size() - 1 + 'A', a.states.size() + 'A', 'E');
+        cronometro.reiniciar();
+        nfa = compileNFA(a);
+        tiemposCSR.push_back(cronometro.milisegundos());
 
-    return result;
-}
+        //Sin alfabeto se usan los bytes que aparecen en las transiciones del AFN
+        if (alphabet.empty()) alphabet = nfaAlphabet(nfa);
 
-Automata unionAutomata(const Automata& a, const Automata& b) {
-    Automata result(a.states.size() + b.states.size() + 2);
+        //El AFD perezoso se construye mientras reconoce las cadenas
+        if (perezoso) continue;
 
-    for (char i = 'A'; i < 'A' + a.states.size(); i++) {
-        for (auto& [c, to] : a.states[i - 'A'].transitions) {
-            result.addTransition(i + 1, to + 1, c);
+        double cerradura;
+        cronometro.reiniciar();
+        if (!subsetConstruction(nfa, alphabet, dfa, cerradura)) {
+            cerr << "Con --perezoso se reconocen las cadenas sin construir el AFD completo" << endl;
+            return 1;
         }
-    }
+        tiemposSubconjuntos.push_back(cronometro.milisegundos());
+        tiemposCerradura.push_back(cerradura);
 
-    for (char i = 'A'; i < 'A' + b.states.size(); i++) {
-        for (auto& [c, to] : b.states[i - 'A'].transitions) {
-            result.addTransition(i + 1 + a.states.size(), to + 1 + a.states.size(), c);
-        }
+        minimal = dfa;
+        cronometro.reiniciar();
+        minimizeDFA(minimal);
+        tiemposHopcroft.push_back(cronometro.milisegundos());
     }
 
-    result.addTransition('A', 'B', 'E');
-    result.addTransition('A', a.states.size() + 'B', 'E');
-
-    result.states[a.states.size()].accepting = false;
-    result.states[a.states.size() + b.states.size()].accepting = false;
-
-    result.addTransition(a.states.size() + 'A', result.states.size() - 1 + 'A', 'E');
-    result.addTransition(a.states.size() + b.states.size() + 'A', result.states.size() - 1 + 'A', 'E');
-
-    return result;
-}
-
-Automata starAutomata(const Automata& a) {
-    Automata result(a.states.size() + 2);
-
-    for (char i = 'A'; i < 'A' + a.states.size(); i++) {
-        for (auto& [c, to] : a.states[i - 'A'].transitions) {
-            result.addTransition(i + 1, to + 1, c);
-        }
+    Reporte reporte("RegularExpressionToAFD");
+    reporte.dato("expresion", regexText);
+    reporte.dato("estados_afn", a.numStates);
+    reporte.agregar("analisis", tiemposAnalisis);
+    reporte.agregar("afn", tiemposAFN);
+    reporte.agregar("csr", tiemposCSR);
+    vector<string> etapas = {"analisis", "afn", "csr"};
+    if (!perezoso) {
+        string simbolos;
+        for (char c : dfa.alphabet) simbolos += symbolName(c);
+        reporte.dato("alfabeto", simbolos);
+        reporte.dato("estados_afd", dfa.numStates);
+        reporte.dato("estados_minimo", minimal.numStates);
+        reporte.agregar("cerradura", tiemposCerradura);
+        reporte.agregar("subconjuntos", tiemposSubconjuntos);
+        reporte.agregar("hopcroft", tiemposHopcroft);
+        etapas.insert(etapas.end(), {"cerradura", "subconjuntos", "hopcroft"});
     }
 
-    result.addTransition('A', 'B', 'E');
-    result.addTransition('A', result.states.size() - 1 + 'A', 'E');
-
-    result.states[a.states.size()].accepting = false;
-
-    result.addTransition(a.states.size() + 'A', 'B', 'E');
-    result.addTransition(a.states.size() + 'A', result.states.size() - 1 + 'A', 'E');
-
-    return result;
-}
+    //El AFD perezoso (solo con --perezoso) reconoce las cadenas y cuenta cuánto le sirvió su caché
+    vector<bool> aceptadas;
+    LazyStats cache;
+    size_t capacidadCache = 0;
+    if (perezoso) {
+        LazyDFA lazy(nfa, alphabet, memoria);
+        for (const string& cadena : cadenas) aceptadas.push_back(lazy.match(cadena));
+        cache = lazy.stats;
+        capacidadCache = lazy.capacity();
+        reporte.dato("cache_estados", capacidadCache);
+        reporte.dato("cache_aciertos", cache.hits);
+        reporte.dato("cache_fallos", cache.misses);
+        reporte.dato("cache_tasa_aciertos", cache.hitRate());
+        reporte.dato("cache_vaciados", cache.flushes);
+    }
 
-string infixToPostfixRegex(string infixRegex) {
-    stack<char> operatorStack;
-    string postfixRegex;
-
-    unordered_map<char, int> precedence;
-    precedence['*'] = 3;
-    precedence['.'] = 2;
-    precedence['|'] = 1;
-    precedence['+'] = 1;
-
-    for (char c : infixRegex) {
-        switch (c) {
-            case '*':
-            case '.':
-            case '|':
-            case '+':
-                while (!operatorStack.empty() && precedence[operatorStack.top()] >= precedence[c]) {
-                    postfixRegex += operatorStack.top();
-                    operatorStack.pop();
-                }
-                operatorStack.push(c);
-                break;
-            case '(':
-                operatorStack.push(c);
-                break;
-            case ')':
-                while (operatorStack.top() != '(') {
-                    postfixRegex += operatorStack.top();
-                    operatorStack.pop();
-                }
-                operatorStack.pop();  // Pop '('
-                break;
-            default:  // Operand
-                postfixRegex += c;
-                break;
-        }
+    if (formato != TEXTO) {
+        reporte.escribir(cout, formato);
+        return 0;
     }
 
-    while (!operatorStack.empty()) {
-        postfixRegex += operatorStack.top();
-        operatorStack.pop();
+    cout << "AFN (" << a.numStates << " estados):\n";
+    a.printAutomata();
+    if (!perezoso) {
+        cout << "\nAFD minimo (" << minimal.numStates << " estados, el 0 es el estado muerto; " << dfa.numStates
+             << " antes de minimizar):\n";
+        minimal.printDFA();
     }
 
-    return postfixRegex;
-}
+    cout << "\nTiempos por etapa (ms):\n";
+    for (const string& etapa : etapas) {
+        cout << "  " << etapa << ": " << reporte.estadisticas(etapa).mediana << '\n';
+    }
+    if (repeticiones > 1) {
+        cout << "(medianas de " << repeticiones << " repeticiones)" << endl;
+    }
 
-Automata constructAutomataFromRegex(string postfixRegex) {
-    stack<Automata> s;
-
-    for (char c : postfixRegex) {
-        switch (c) {
-            case '*':
-                s.push(starAutomata(s.top()));
-                s.pop();
-                break;
-            case '|':
-            case '+':
-                {
-                Automata b = s.top(); s.pop();
-                Automata a = s.top(); s.pop();
-                s.push(unionAutomata(a, b));
-                }
-                break;
-            case '.':
-                {
-                Automata b = s.top(); s.pop();
-                Automata a = s.top(); s.pop();
-                s.push(concatenateAutomata(a, b));
-                }
-                break;
-            default:
-                s.push(Automata(c));
-                break;
+    if (perezoso) {
+        cout << "\nCadenas (AFD perezoso, caché de " << capacidadCache << " estados):\n";
+        for (size_t i = 0; i < cadenas.size(); i++) {
+            cout << "  \"" << cadenas[i] << "\": " << (aceptadas[i] ? "acepta" : "rechaza") << '\n';
+        }
+        cout << "Cache: " << cache.hits << " aciertos, " << cache.misses << " fallos (tasa de aciertos "
+             << cache.hitRate() << "), " << cache.states << " estados creados, " << cache.flushes << " vaciados" << endl;
+    } else if (!cadenas.empty()) {
+        Matcher matcher(minimal);
+        cout << "\nCadenas (" << matcher.numClasses() << " clases de bytes):\n";
+        for (const string& cadena : cadenas) {
+            cout << "  \"" << cadena << "\": " << (matcher.match(cadena) ? "acepta" : "rechaza") << '\n';
         }
     }
 
-    return s.top();
-}
-
-int main() {
-    ifstream file("input.txt");
-
-    string infixRegex, alphabet;
-    file >> infixRegex >> alphabet;
-
-    string postfixRegex = infixToPostfixRegex(infixRegex);
-
-    Automata a = constructAutomataFromRegex(postfixRegex);
-
-    a.printAutomata();
-
     return 0;
-}
\ No newline at end of file
+}
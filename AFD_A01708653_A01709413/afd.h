@@ -0,0 +1,404 @@
+// ==========================================================================
+// File: afd.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene la conversión del AFN compilado de automata.h en un AFD:
+//              cerradura-ε con conjuntos de estados como mapas de bits, construcción de
+//              subconjuntos sobre el alfabeto de input.txt (o el de la expresión si no se da
+//              uno) y minimización de Hopcroft.
+//              El resultado es una tabla densa de transiciones de uint16_t donde el
+//              estado 0 es el estado muerto, así que reconocer una cadena es solo
+//              consultar la tabla una vez por símbolo.
+// ===========================================================================================
+
+#ifndef AFD_H
+#define AFD_H
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../comun/perfilador.h"
+#include "automata.h"
+
+// Los estados se guardan en uint16_t
+const size_t MAX_DFA_STATES = 65536;
+
+struct DFA {
+    int numStates = 0;
+    int numSymbols = 0;             // Una columna por símbolo del alfabeto y una más para cualquier otro byte
+    uint16_t start = 0;
+    std::string alphabet;
+    uint8_t column[256];            // Columna de cada byte
+    std::vector<uint16_t> table;    // table[q * numSymbols + column[b]]: siguiente estado
+    std::vector<uint8_t> accepting;
+
+    uint16_t next(uint16_t q, unsigned char b) const {
+        return table[q * numSymbols + column[b]];
+    }
+
+    // La cadena completa pertenece al lenguaje; el estado muerto no tiene salida, así que no hace falta revisarlo
+    bool accepts(const std::string& input) const {
+        uint16_t q = start;
+        for (unsigned char b : input) q = next(q, b);
+        return accepting[q];
+    }
+
+    void printDFA() const {
+        for (int q = 1; q < numStates; q++) {
+            std::cout << "State " << q << (q == start ? " (Start)" : "") << (accepting[q] ? " (Accepting)" : "") << ":\n";
+            for (size_t c = 0; c < alphabet.size(); c++) {
+                uint16_t to = table[q * numSymbols + c];
+                if (to != 0) std::cout << "  --(" << symbolName(alphabet[c]) << ")--> " << to << '\n';
+            }
+        }
+    }
+};
+
+// Conjunto de estados del AFN: un bit por estado en palabras de 64 bits
+typedef std::vector<uint64_t> StateSet;
+
+inline void addState(StateSet& set, uint32_t state) {
+    set[state >> 6] |= 1ULL << (state & 63);
+}
+
+inline bool hasState(const StateSet& set, uint32_t state) {
+    return (set[state >> 6] >> (state & 63)) & 1;
+}
+
+/*
+Cerradura-ε: agrega a set todo lo que se alcanza con transiciones vacías desde los estados de
+pending, que ya deben estar en set. Cada estado entra a la pila una sola vez, así que cuesta lo
+mismo que las aristas que se recorren.
+*/
+inline void epsilonClosure(const NFA& nfa, StateSet& set, std::vector<uint32_t>& pending) {
+    while (!pending.empty()) {
+        uint32_t state = pending.back();
+        pending.pop_back();
+        for (uint32_t i = nfa.epsilonStart[state]; i < nfa.epsilonStart[state + 1]; i++) {
+            uint32_t to = nfa.epsilonTargets[i];
+            if (!hasState(set, to)) {
+                addState(set, to);
+                pending.push_back(to);
+            }
+        }
+    }
+}
+
+/*
+Tabla hash de los conjuntos ya vistos, con direccionamiento abierto: guarda el número de estado del
+AFD y los conjuntos se comparan en sets, donde cada uno ocupa words palabras.
+*/
+class StateSetIndex {
+public:
+    explicit StateSetIndex(size_t words) : words(words), slots(1024, -1) {}
+
+    static uint64_t hash(const uint64_t* set, size_t words) {
+        uint64_t h = 14695981039346656037ULL;      // FNV-1a por palabras
+        for (size_t i = 0; i < words; i++) h = (h ^ set[i]) * 1099511628211ULL;
+        return h;
+    }
+
+    // Número del conjunto en sets, o -1 si no está
+    int find(const std::vector<uint64_t>& sets, const uint64_t* set, uint64_t h) const {
+        for (size_t i = h & (slots.size() - 1);; i = (i + 1) & (slots.size() - 1)) {
+            if (slots[i] < 0) return -1;
+            if (hashes[slots[i]] == h && memcmp(&sets[slots[i] * words], set, words * 8) == 0) return slots[i];
+        }
+    }
+
+    // Registra el conjunto id (que ya está en sets) con su hash
+    void insert(int id, uint64_t h) {
+        hashes.push_back(h);
+        if (hashes.size() * 2 > slots.size()) {
+            slots.assign(slots.size() * 2, -1);
+            for (size_t k = 0; k < hashes.size(); k++) place(k);
+        } else {
+            place(id);
+        }
+    }
+
+private:
+    void place(int id) {
+        size_t i = hashes[id] & (slots.size() - 1);
+        while (slots[i] >= 0) i = (i + 1) & (slots.size() - 1);
+        slots[i] = id;
+    }
+
+    size_t words;
+    std::vector<int> slots;
+    std::vector<uint64_t> hashes;
+};
+
+/*
+Columnas de un AFD: cada símbolo distinto del alfabeto tiene la suya y cualquier otro byte cae en la
+última. Regresa el alfabeto sin repetidos, en el orden de sus columnas.
+*/
+inline std::string setColumns(const std::string& alphabet, uint8_t column[256]) {
+    std::string symbols;
+    for (char c : alphabet) {
+        if (symbols.find(c) == std::string::npos) symbols += c;
+    }
+    memset(column, symbols.size(), 256);
+    for (size_t c = 0; c < symbols.size(); c++) column[(unsigned char) symbols[c]] = c;
+    return symbols;
+}
+
+/*
+Construcción de subconjuntos: cada estado del AFD es la cerradura-ε de un conjunto de estados del
+AFN. El estado 0 es el conjunto vacío (el estado muerto) y el 1 la cerradura del estado inicial. Los
+estados se procesan en el orden en que se descubren y de cada uno se calculan todas las columnas en
+una sola pasada por sus estados del AFN; las transiciones con símbolos fuera del alfabeto nunca se
+pueden tomar y se ignoran. closureMs acumula el tiempo de las cerraduras-ε. Regresa false si el AFD
+no cabe en MAX_DFA_STATES estados.
+*/
+inline bool subsetConstruction(const NFA& nfa, const std::string& alphabet, DFA& dfa, double& closureMs) {
+    dfa.alphabet = setColumns(alphabet, dfa.column);
+    dfa.numSymbols = dfa.alphabet.size() + 1;
+    size_t symbols = dfa.alphabet.size();
+    size_t words = (nfa.numStates + 63) / 64;
+
+    std::vector<uint64_t> sets;     // El conjunto de cada estado del AFD, uno tras otro
+    StateSetIndex index(words);
+    dfa.table.clear();
+    dfa.accepting.clear();
+    closureMs = 0;
+
+    // Agrega un conjunto nuevo como estado del AFD y regresa su número
+    auto addDFAState = [&](const StateSet& set, uint64_t h) {
+        int id = dfa.accepting.size();
+        sets.insert(sets.end(), set.begin(), set.end());
+        index.insert(id, h);
+        dfa.accepting.push_back(hasState(set, nfa.accept));
+        dfa.table.resize(dfa.table.size() + dfa.numSymbols, 0);
+        return id;
+    };
+
+    StateSet set(words, 0);
+    std::vector<uint32_t> pending;
+    addDFAState(set, StateSetIndex::hash(set.data(), words));
+    addState(set, nfa.start);
+    pending.push_back(nfa.start);
+    {
+        Cronometro cronometro;
+        epsilonClosure(nfa, set, pending);
+        closureMs += cronometro.milisegundos();
+    }
+    dfa.start = addDFAState(set, StateSetIndex::hash(set.data(), words));
+
+    std::vector<StateSet> targets(symbols, StateSet(words));
+    std::vector<std::vector<uint32_t>> targetPending(symbols);
+    for (size_t q = 1; q < dfa.accepting.size(); q++) {
+        for (size_t c = 0; c < symbols; c++) {
+            std::fill(targets[c].begin(), targets[c].end(), 0);
+            targetPending[c].clear();
+        }
+        // Mover: los destinos de todos los estados del conjunto, repartidos por columna
+        for (size_t w = 0; w < words; w++) {
+            uint64_t word = sets[q * words + w];
+            while (word) {
+                uint32_t state = w * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+                for (uint32_t i = nfa.moveStart[state]; i < nfa.moveStart[state + 1]; i++) {
+                    size_t c = dfa.column[nfa.moveSymbols[i]];
+                    uint32_t to = nfa.moveTargets[i];
+                    if (c < symbols && !hasState(targets[c], to)) {
+                        addState(targets[c], to);
+                        targetPending[c].push_back(to);
+                    }
+                }
+            }
+        }
+        for (size_t c = 0; c < symbols; c++) {
+            Cronometro cronometro;
+            epsilonClosure(nfa, targets[c], targetPending[c]);
+            closureMs += cronometro.milisegundos();
+
+            uint64_t h = StateSetIndex::hash(targets[c].data(), words);
+            int id = index.find(sets, targets[c].data(), h);
+            if (id < 0) {
+                if (dfa.accepting.size() == MAX_DFA_STATES) {
+                    std::cerr << "El AFD tiene mas de " << MAX_DFA_STATES << " estados" << std::endl;
+                    return false;
+                }
+                id = addDFAState(targets[c], h);
+            }
+            dfa.table[q * dfa.numSymbols + c] = id;
+        }
+    }
+    dfa.numStates = dfa.accepting.size();
+    return true;
+}
+
+/*
+Minimización de Hopcroft. La partición empieza con los estados de aceptación y los demás, y se
+refina con cada bloque de la lista de trabajo: para cada símbolo se marcan los estados que llegan
+al bloque con ese símbolo y cada bloque que queda marcado solo en parte se divide en dos. Si el
+bloque dividido ya estaba en la lista se agregan las dos partes; si no, basta con la más pequeña,
+y por eso el total es O(n k log n). Los bloques viven en un solo arreglo (elements) en el que cada
+bloque es un rango y los estados marcados se van moviendo al principio de su rango.
+*/
+inline void minimizeDFA(DFA& dfa) {
+    int n = dfa.numStates;
+    int symbols = dfa.alphabet.size();     // La última columna siempre lleva al estado muerto y no separa nada
+
+    // Transiciones inversas por símbolo en un arreglo plano: los estados que llegan a q con c son
+    // predecessors[start[c * (n + 1) + q] .. start[c * (n + 1) + q + 1])
+    std::vector<int> start(symbols * (n + 1) + 1, 0), predecessors(symbols * n);
+    for (int c = 0; c < symbols; c++) {
+        int* s = &start[c * (n + 1)];
+        for (int p = 0; p < n; p++) s[dfa.table[p * dfa.numSymbols + c] + 1]++;
+        for (int q = 0; q < n; q++) s[q + 1] += s[q];
+        std::vector<int> position(s, s + n);
+        for (int p = 0; p < n; p++) predecessors[c * n + position[dfa.table[p * dfa.numSymbols + c]]++] = p;
+    }
+
+    std::vector<int> elements(n), location(n), blockOf(n);
+    std::vector<int> first, end, marked;
+    std::vector<uint8_t> inWorklist;
+    std::vector<int> worklist, touched;
+
+    // Partición inicial: primero los que no aceptan y después los que aceptan
+    int k = 0;
+    for (int accepts = 0; accepts < 2; accepts++) {
+        int begin = k;
+        for (int q = 0; q < n; q++) {
+            if (dfa.accepting[q] != accepts) continue;
+            elements[k] = q;
+            location[q] = k++;
+            blockOf[q] = first.size();
+        }
+        if (k > begin) {
+            first.push_back(begin);
+            end.push_back(k);
+            marked.push_back(0);
+            inWorklist.push_back(0);
+        }
+    }
+    int smallest = first.size() == 2 && end[1] - first[1] < end[0] - first[0] ? 1 : 0;
+    worklist.push_back(smallest);
+    inWorklist[smallest] = 1;
+
+    std::vector<int> splitter;
+    while (!worklist.empty()) {
+        int a = worklist.back();
+        worklist.pop_back();
+        inWorklist[a] = 0;
+        splitter.assign(elements.begin() + first[a], elements.begin() + end[a]);
+
+        for (int c = 0; c < symbols; c++) {
+            const int* s = &start[c * (n + 1)];
+            for (int q : splitter) {
+                for (int i = s[q]; i < s[q + 1]; i++) {
+                    int p = predecessors[c * n + i];
+                    int b = blockOf[p];
+                    int j = first[b] + marked[b];
+                    if (location[p] < j) continue;     // Ya estaba marcado
+                    if (marked[b] == 0) touched.push_back(b);
+                    int other = elements[j];
+                    elements[j] = p;
+                    elements[location[p]] = other;
+                    location[other] = location[p];
+                    location[p] = j;
+                    marked[b]++;
+                }
+            }
+            for (int b : touched) {
+                if (marked[b] == end[b] - first[b]) {
+                    marked[b] = 0;
+                    continue;
+                }
+                // Los marcados forman el bloque nuevo y el resto se queda con el número b
+                int nb = first.size();
+                first.push_back(first[b]);
+                end.push_back(first[b] + marked[b]);
+                marked.push_back(0);
+                inWorklist.push_back(0);
+                first[b] += marked[b];
+                marked[b] = 0;
+                for (int i = first[nb]; i < end[nb]; i++) blockOf[elements[i]] = nb;
+
+                int add = inWorklist[b] || end[nb] - first[nb] <= end[b] - first[b] ? nb : b;
+                if (!inWorklist[add]) {
+                    worklist.push_back(add);
+                    inWorklist[add] = 1;
+                }
+            }
+            touched.clear();
+        }
+    }
+
+    // Numeración final: el bloque del estado muerto es el 0 y los demás en el orden en que se
+    // alcanzan desde el inicial
+    int blocks = first.size();
+    std::vector<int> newId(blocks, -1);
+    std::vector<int> order;
+    newId[blockOf[0]] = 0;
+    order.push_back(blockOf[0]);
+    if (newId[blockOf[dfa.start]] < 0) {
+        newId[blockOf[dfa.start]] = order.size();
+        order.push_back(blockOf[dfa.start]);
+    }
+    for (size_t i = 1; i < order.size(); i++) {
+        int representative = elements[first[order[i]]];
+        for (int c = 0; c < symbols; c++) {
+            int b = blockOf[dfa.table[representative * dfa.numSymbols + c]];
+            if (newId[b] < 0) {
+                newId[b] = order.size();
+                order.push_back(b);
+            }
+        }
+    }
+
+    std::vector<uint16_t> table(order.size() * dfa.numSymbols, 0);
+    std::vector<uint8_t> accepting(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        int representative = elements[first[order[i]]];
+        accepting[i] = dfa.accepting[representative];
+        for (int c = 0; c < symbols; c++) {
+            table[i * dfa.numSymbols + c] = newId[blockOf[dfa.table[representative * dfa.numSymbols + c]]];
+        }
+    }
+    dfa.start = newId[blockOf[dfa.start]];
+    dfa.numStates = order.size();
+    dfa.table.swap(table);
+    dfa.accepting.swap(accepting);
+}
+
+/*
+Alfabeto de un AFN: los bytes que aparecen en alguna transición, de menor a mayor. Es el alfabeto que
+se usa cuando no se da otro, y con él el AFD distingue todo lo que la expresión puede distinguir.
+*/
+inline std::string nfaAlphabet(const NFA& nfa) {
+    bool seen[256] = {};
+    for (uint8_t b : nfa.moveSymbols) seen[b] = true;
+    std::string alphabet;
+    for (int b = 0; b < 256; b++) {
+        if (seen[b]) alphabet += (char) b;
+    }
+    return alphabet;
+}
+
+/*
+Todas las etapas de una vez: expresión -> árbol -> AFN -> AFD -> AFD mínimo. Si alphabet está vacío
+se usa el del AFN. Los errores de la expresión se escriben en cerr con su posición.
+*/
+inline bool regexToDFA(const std::string& regexText, const std::string& alphabet, DFA& dfa) {
+    Regex regex;
+    std::string error;
+    size_t errorPosition;
+    if (!parseRegex(regexText, regex, error, errorPosition)) {
+        std::cerr << "Error en la expresion \"" << regexText << "\", posicion " << errorPosition << ": " << error << std::endl;
+        return false;
+    }
+    NFA nfa = compileNFA(constructAutomata(regex));
+    double closureMs;
+    if (!subsetConstruction(nfa, alphabet.empty() ? nfaAlphabet(nfa) : alphabet, dfa, closureMs)) {
+        return false;
+    }
+    minimizeDFA(dfa);
+    return true;
+}
+
+#endif
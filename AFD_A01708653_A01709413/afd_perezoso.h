@@ -0,0 +1,188 @@
+// ==========================================================================
+// File: afd_perezoso.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene el AFD perezoso: en vez de construir todos los
+//              subconjuntos antes de reconocer (que puede ser exponencial, por ejemplo con
+//              (a|b)*a(a|b)(a|b)...), cada estado y cada transición se calculan la primera
+//              vez que el recorrido los necesita y se guardan en una caché de tamaño fijo.
+//              Cuando la caché se llena se vacía completa y se sigue desde el estado actual,
+//              así que la memoria nunca pasa del límite y el costo de cada vaciado está
+//              acotado. Lleva la cuenta de aciertos, fallos y vaciados.
+// ===========================================================================================
+
+#ifndef AFD_PEREZOSO_H
+#define AFD_PEREZOSO_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "afd.h"
+
+struct LazyStats {
+    uint64_t hits = 0;          // Transiciones que ya estaban en la caché
+    uint64_t misses = 0;        // Transiciones que hubo que calcular
+    uint64_t states = 0;        // Estados creados en total (contando los que se crearon de nuevo tras vaciar)
+    uint64_t flushes = 0;       // Veces que se vació la caché
+
+    double hitRate() const {
+        return hits + misses ? (double) hits / (hits + misses) : 0;
+    }
+};
+
+/*
+Los estados de la caché se numeran como en subsetConstruction: el 0 es el conjunto vacío (el estado
+muerto) y el 1 la cerradura del inicial. La tabla guarda -1 en las transiciones que todavía no se
+conocen. Cada estado ocupa sus palabras del conjunto, su renglón de la tabla y su lugar en el índice,
+así que el número de estados que caben sale directamente del límite de memoria.
+*/
+class LazyDFA {
+public:
+    LazyDFA(const NFA& nfa, const std::string& alphabet, size_t memoryBytes) : nfa(nfa), index(1) {
+        symbols = setColumns(alphabet, column);
+        numSymbols = symbols.size() + 1;
+        words = (nfa.numStates + 63) / 64;
+        size_t bytesPerState = words * 8 + numSymbols * 4 + 1 + 8 + 4 * 4;     // Conjunto, renglón, aceptación, hash y lugares del índice
+        maxStates = memoryBytes / bytesPerState;
+        if (maxStates < 4) maxStates = 4;       // El muerto, el inicial, el actual y su destino
+        target.assign(words, 0);
+        saved.assign(words, 0);
+        flush();
+        stats.flushes = 0;
+    }
+
+    // La cadena completa pertenece al lenguaje
+    bool match(std::string_view input) {
+        int32_t state = start;
+        for (unsigned char b : input) {
+            state = step(state, column[b]);
+            if (state == 0) break;
+        }
+        return accepting[state];
+    }
+
+    // Siguiente estado desde state con la columna c; si no se conoce se calcula y se guarda
+    int32_t step(int32_t state, int c) {
+        int32_t known = table[state * numSymbols + c];
+        if (known >= 0) {
+            stats.hits++;
+            return known;
+        }
+        stats.misses++;
+
+        // Mover con c y cerrar con las transiciones vacías
+        std::fill(target.begin(), target.end(), 0);
+        if (c < (int) symbols.size()) {
+            for (size_t w = 0; w < words; w++) {
+                uint64_t word = sets[state * words + w];
+                while (word) {
+                    uint32_t q = w * 64 + __builtin_ctzll(word);
+                    word &= word - 1;
+                    for (uint32_t i = nfa.moveStart[q]; i < nfa.moveStart[q + 1]; i++) {
+                        uint32_t to = nfa.moveTargets[i];
+                        if (column[nfa.moveSymbols[i]] == c && !hasState(target, to)) {
+                            addState(target, to);
+                            pending.push_back(to);
+                        }
+                    }
+                }
+            }
+            epsilonClosure(nfa, target, pending);
+        }
+
+        uint64_t h = StateSetIndex::hash(target.data(), words);
+        int32_t id = index.find(sets, target.data(), h);
+        if (id < 0) {
+            if (accepting.size() == maxStates) {
+                // Sin lugar: se vacía la caché conservando solo el conjunto del estado actual
+                copy(sets.begin() + state * words, sets.begin() + (state + 1) * words, saved.begin());
+                flush();
+                state = find(saved);
+                h = StateSetIndex::hash(target.data(), words);
+                id = index.find(sets, target.data(), h);
+            }
+            if (id < 0) id = add(target, h);
+        }
+        table[state * numSymbols + c] = id;
+        return id;
+    }
+
+    int32_t startState() const {
+        return start;
+    }
+
+    bool isAccepting(int32_t state) const {
+        return accepting[state];
+    }
+
+    uint8_t columnOf(unsigned char b) const {
+        return column[b];
+    }
+
+    size_t capacity() const {
+        return maxStates;
+    }
+
+    size_t cachedStates() const {
+        return accepting.size();
+    }
+
+    LazyStats stats;
+
+private:
+    // Número del conjunto en la caché; si no está lo agrega
+    int32_t find(const StateSet& set) {
+        uint64_t h = StateSetIndex::hash(set.data(), words);
+        int32_t id = index.find(sets, set.data(), h);
+        return id >= 0 ? id : add(set, h);
+    }
+
+    int32_t add(const StateSet& set, uint64_t h) {
+        int32_t id = accepting.size();
+        sets.insert(sets.end(), set.begin(), set.end());
+        index.insert(id, h);
+        accepting.push_back(hasState(set, nfa.accept));
+        table.resize(table.size() + numSymbols, -1);
+        stats.states++;
+        return id;
+    }
+
+    // Deja la caché solo con el estado muerto y el inicial
+    void flush() {
+        stats.flushes++;
+        sets.clear();
+        accepting.clear();
+        table.clear();
+        sets.reserve(maxStates * words);
+        accepting.reserve(maxStates);
+        table.reserve(maxStates * numSymbols);
+        index = StateSetIndex(words);
+
+        StateSet set(words, 0);
+        int32_t dead = add(set, StateSetIndex::hash(set.data(), words));
+        std::fill(table.begin() + dead * numSymbols, table.begin() + (dead + 1) * numSymbols, dead);
+        addState(set, nfa.start);
+        pending.push_back(nfa.start);
+        epsilonClosure(nfa, set, pending);
+        start = add(set, StateSetIndex::hash(set.data(), words));
+    }
+
+    const NFA& nfa;
+    std::string symbols;
+    int numSymbols;
+    uint8_t column[256];
+    size_t words;
+    size_t maxStates;
+
+    std::vector<uint64_t> sets;
+    std::vector<uint8_t> accepting;
+    std::vector<int32_t> table;
+    StateSetIndex index;
+    int32_t start = 1;
+
+    StateSet target, saved;
+    std::vector<uint32_t> pending;
+};
+
+#endif
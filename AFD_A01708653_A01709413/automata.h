@@ -0,0 +1,266 @@
+// ==========================================================================
+// File: automata.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene el AFN de una expresión regular con la construcción
+//              de Thompson que usa RegularExpressionToAFD.cpp: recorre el árbol que produce
+//              expresion.h con las operaciones de concatenación, unión, estrella, una o más
+//              veces y opcional. Los estados son enteros, todos los fragmentos comparten un
+//              solo depósito de estados y las transiciones son un arreglo plano que se compila
+//              a formato CSR para recorrerlo.
+// ===========================================================================================
+
+#ifndef AUTOMATA_H
+#define AUTOMATA_H
+
+#include <bitset>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "expresion.h"
+
+// Símbolo de las transiciones vacías
+const int EPSILON = -1;
+
+// Una transición del AFN: los estados son enteros, así que no hay límite en su número
+struct Edge {
+    uint32_t from;
+    uint32_t to;
+    int32_t symbol;     // El byte del símbolo o EPSILON
+};
+
+/*
+AFN mientras se construye. Todos los estados y transiciones de la expresión viven en este único
+depósito: las transiciones van en un solo arreglo (una arena que solo crece) y cada operador solo
+agrega estados y transiciones vacías nuevas, sin copiar nada de sus operandos.
+*/
+class Automata {
+public:
+    uint32_t numStates = 0;
+    uint32_t start = 0;
+    uint32_t accept = 0;
+    std::vector<Edge> edges;
+
+    uint32_t addState() {
+        return numStates++;
+    }
+
+    void addTransition(uint32_t from, uint32_t to, int32_t c) {
+        edges.push_back({from, to, c});
+    }
+
+    void printAutomata() const;
+};
+
+// Un pedazo del AFN dentro del depósito: su estado inicial y su estado de aceptación
+struct Fragment {
+    uint32_t start;
+    uint32_t accept;
+};
+
+/*
+AFN compilado en formato CSR: las transiciones de cada estado quedan contiguas en arreglos planos, las
+vacías separadas de las que consumen un símbolo. Las vacías de q son
+epsilonTargets[epsilonStart[q] .. epsilonStart[q + 1]) y puede haber cuantas se necesiten.
+*/
+struct NFA {
+    uint32_t numStates = 0;
+    uint32_t start = 0;
+    uint32_t accept = 0;
+    std::vector<uint32_t> epsilonStart;
+    std::vector<uint32_t> epsilonTargets;
+    std::vector<uint32_t> moveStart;
+    std::vector<uint32_t> moveTargets;
+    std::vector<uint8_t> moveSymbols;
+};
+
+// Ordena las transiciones por estado de origen con un conteo, así que cuesta O(estados + transiciones)
+inline NFA compileNFA(const Automata& a) {
+    NFA nfa;
+    nfa.numStates = a.numStates;
+    nfa.start = a.start;
+    nfa.accept = a.accept;
+    nfa.epsilonStart.assign(a.numStates + 1, 0);
+    nfa.moveStart.assign(a.numStates + 1, 0);
+    for (const Edge& e : a.edges) {
+        (e.symbol == EPSILON ? nfa.epsilonStart : nfa.moveStart)[e.from + 1]++;
+    }
+    for (uint32_t q = 0; q < a.numStates; q++) {
+        nfa.epsilonStart[q + 1] += nfa.epsilonStart[q];
+        nfa.moveStart[q + 1] += nfa.moveStart[q];
+    }
+    nfa.epsilonTargets.resize(nfa.epsilonStart[a.numStates]);
+    nfa.moveTargets.resize(nfa.moveStart[a.numStates]);
+    nfa.moveSymbols.resize(nfa.moveStart[a.numStates]);
+    std::vector<uint32_t> epsilonNext(nfa.epsilonStart.begin(), nfa.epsilonStart.end() - 1);
+    std::vector<uint32_t> moveNext(nfa.moveStart.begin(), nfa.moveStart.end() - 1);
+    for (const Edge& e : a.edges) {
+        if (e.symbol == EPSILON) {
+            nfa.epsilonTargets[epsilonNext[e.from]++] = e.to;
+        } else {
+            uint32_t i = moveNext[e.from]++;
+            nfa.moveTargets[i] = e.to;
+            nfa.moveSymbols[i] = e.symbol;
+        }
+    }
+    return nfa;
+}
+
+// El símbolo como se imprime: los bytes que no se ven van como \xHH
+inline std::string symbolName(uint8_t b) {
+    if (b >= 0x21 && b < 0x7f) return std::string(1, (char) b);
+    const char* digits = "0123456789abcdef";
+    return std::string("\\x") + digits[b >> 4] + digits[b & 15];
+}
+
+inline void Automata::printAutomata() const {
+    NFA nfa = compileNFA(*this);
+    for (uint32_t q = 0; q < nfa.numStates; q++) {
+        std::cout << "State " << q << (q == nfa.start ? " (Start)" : "") << (q == nfa.accept ? " (Accepting)" : "") << ":\n";
+        for (uint32_t i = nfa.moveStart[q]; i < nfa.moveStart[q + 1]; i++) {
+            std::cout << "  --(" << symbolName(nfa.moveSymbols[i]) << ")--> " << nfa.moveTargets[i] << '\n';
+        }
+        for (uint32_t i = nfa.epsilonStart[q]; i < nfa.epsilonStart[q + 1]; i++) {
+            std::cout << "  --(ε)--> " << nfa.epsilonTargets[i] << '\n';
+        }
+    }
+}
+
+// Dos estados unidos por el símbolo c (un byte o EPSILON)
+inline Fragment symbolAutomata(Automata& pool, int32_t c) {
+    Fragment f{pool.addState(), pool.addState()};
+    pool.addTransition(f.start, f.accept, c);
+    return f;
+}
+
+// Dos estados unidos por una transición con cada byte del conjunto
+inline Fragment setAutomata(Automata& pool, const std::bitset<256>& bytes) {
+    Fragment f{pool.addState(), pool.addState()};
+    for (int b = 0; b < 256; b++) {
+        if (bytes.test(b)) pool.addTransition(f.start, f.accept, b);
+    }
+    return f;
+}
+
+inline Fragment concatenateAutomata(Automata& pool, Fragment a, Fragment b) {
+    pool.addTransition(a.accept, b.start, EPSILON);
+    return {a.start, b.accept};
+}
+
+inline Fragment unionAutomata(Automata& pool, Fragment a, Fragment b) {
+    Fragment result{pool.addState(), pool.addState()};
+
+    pool.addTransition(result.start, a.start, EPSILON);
+    pool.addTransition(result.start, b.start, EPSILON);
+
+    pool.addTransition(a.accept, result.accept, EPSILON);
+    pool.addTransition(b.accept, result.accept, EPSILON);
+
+    return result;
+}
+
+inline Fragment starAutomata(Automata& pool, Fragment a) {
+    Fragment result{pool.addState(), pool.addState()};
+
+    pool.addTransition(result.start, a.start, EPSILON);
+    pool.addTransition(result.start, result.accept, EPSILON);
+
+    pool.addTransition(a.accept, a.start, EPSILON);
+    pool.addTransition(a.accept, result.accept, EPSILON);
+
+    return result;
+}
+
+// Una o más veces: como la estrella pero sin el atajo del inicio al final
+inline Fragment plusAutomata(Automata& pool, Fragment a) {
+    Fragment result{pool.addState(), pool.addState()};
+
+    pool.addTransition(result.start, a.start, EPSILON);
+    pool.addTransition(a.accept, a.start, EPSILON);
+    pool.addTransition(a.accept, result.accept, EPSILON);
+
+    return result;
+}
+
+// Cero o una vez: como la estrella pero sin regresar al inicio
+inline Fragment optionalAutomata(Automata& pool, Fragment a) {
+    Fragment result{pool.addState(), pool.addState()};
+
+    pool.addTransition(result.start, a.start, EPSILON);
+    pool.addTransition(result.start, result.accept, EPSILON);
+    pool.addTransition(a.accept, result.accept, EPSILON);
+
+    return result;
+}
+
+/*
+Construye el fragmento del nodo del árbol. {m,n} no tiene construcción propia: son m copias del operando
+concatenadas seguidas de n - m copias opcionales ({m,} termina con una copia con estrella), así que
+cada copia se construye de nuevo desde el árbol.
+*/
+inline Fragment buildFragment(Automata& pool, const Regex& regex, int node) {
+    const RegexNode& n = regex.nodes[node];
+    switch (n.kind) {
+        case NODE_EPSILON:
+            return symbolAutomata(pool, EPSILON);
+        case NODE_SET:
+            return setAutomata(pool, regex.sets[n.set]);
+        case NODE_CONCAT: {
+            Fragment result = buildFragment(pool, regex, n.firstChild);
+            for (int child = regex.nodes[n.firstChild].nextSibling; child >= 0; child = regex.nodes[child].nextSibling) {
+                result = concatenateAutomata(pool, result, buildFragment(pool, regex, child));
+            }
+            return result;
+        }
+        case NODE_UNION: {
+            // Una sola pareja de estados nuevos para todas las alternativas
+            Fragment result{pool.addState(), pool.addState()};
+            for (int child = n.firstChild; child >= 0; child = regex.nodes[child].nextSibling) {
+                Fragment f = buildFragment(pool, regex, child);
+                pool.addTransition(result.start, f.start, EPSILON);
+                pool.addTransition(f.accept, result.accept, EPSILON);
+            }
+            return result;
+        }
+        case NODE_STAR:
+            return starAutomata(pool, buildFragment(pool, regex, n.firstChild));
+        case NODE_PLUS:
+            return plusAutomata(pool, buildFragment(pool, regex, n.firstChild));
+        case NODE_OPTIONAL:
+            return optionalAutomata(pool, buildFragment(pool, regex, n.firstChild));
+        case NODE_REPEAT: {
+            if (n.max == 0) return symbolAutomata(pool, EPSILON);
+            bool hasResult = false;
+            Fragment result{0, 0};
+            auto append = [&](Fragment f) {
+                result = hasResult ? concatenateAutomata(pool, result, f) : f;
+                hasResult = true;
+            };
+            for (int i = 0; i < n.min; i++) append(buildFragment(pool, regex, n.firstChild));
+            if (n.max < 0) {
+                append(starAutomata(pool, buildFragment(pool, regex, n.firstChild)));
+            } else {
+                for (int i = n.min; i < n.max; i++) append(optionalAutomata(pool, buildFragment(pool, regex, n.firstChild)));
+            }
+            return result;
+        }
+    }
+    return symbolAutomata(pool, EPSILON);
+}
+
+/*
+Construye el AFN de Thompson de una expresión ya analizada. El analizador calcula cuántos estados y
+transiciones ocupa cada nodo, así que el arreglo de transiciones se reserva de una vez y la
+construcción no vuelve a pedir memoria.
+*/
+inline Automata constructAutomata(const Regex& regex) {
+    Automata pool;
+    pool.edges.reserve(regex.nodes[regex.root].edges);
+    Fragment f = buildFragment(pool, regex, regex.root);
+    pool.start = f.start;
+    pool.accept = f.accept;
+    return pool;
+}
+
+#endif
@@ -0,0 +1,275 @@
+// ===========================================================================================
+// File: benchmark.cpp
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Pruebas de rendimiento de la construcción del AFN (automata.h) con expresiones
+//              aleatorias de distintos tamaños (por omisión 10, 1,000 y 100,000 símbolos).
+//              Mide por separado el análisis de la expresión, la construcción de Thompson y la
+//              compilación a CSR, con calentamiento e iteraciones (comun/perfilador.h), y
+//              reporta en JSON los nanosegundos por símbolo de cada tamaño: si la construcción
+//              es lineal deben quedar parejos. También mide en GB/s el reconocedor
+//              (reconocedor.h) sobre un texto grande: match, por pedazos, find_all, y muchas
+//              cadenas cortas una por una contra match_batch; y el AFD perezoso
+//              (afd_perezoso.h) con la misma expresión y con una cuyo AFD completo no cabe,
+//              (a|b)*a(a|b)... con --explosion copias de (a|b), con su tasa de aciertos.
+//              To compile: g++ -std=c++17 -O2 benchmark.cpp -o benchmark
+//              y después  ./benchmark [--tamanos 10,1000,100000] [--semilla S]
+//                         [--warmup N] [--iteraciones N] [--expresion EXPR] [--buscar EXPR]
+//                         [--alfabeto ab] [--megabytes N] [--cadenas N] [--explosion N]
+//                         [--memoria BYTES]
+// ===========================================================================================
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include "../comun/perfilador.h"
+#include "automata.h"
+#include "afd.h"
+#include "reconocedor.h"
+#include "afd_perezoso.h"
+
+using namespace std;
+
+struct Opciones {
+    vector<size_t> tamanos = {10, 1000, 100000};
+    uint64_t semilla = 1;
+    int warmup = 2;
+    int iteraciones = 10;
+    string expresion = "(a|b)*a(a|b)(a|b)";      // Nunca cae en el estado muerto: se lee todo el texto
+    string buscar = "ab*a";
+    string alfabeto = "ab";
+    size_t megabytes = 64;
+    size_t cadenas = 1 << 20;
+    int explosion = 20;
+    size_t memoria = 1 << 20;               // Caché del AFD perezoso
+};
+
+struct Resultado {
+    size_t simbolos;
+    uint32_t estados;
+    size_t transiciones;
+    Estadisticas analisis, afn, csr;        // ms por construcción
+};
+
+struct Velocidad {
+    string prueba;
+    size_t bytes;
+    Estadisticas tiempo;
+    size_t resultado;                       // Coincidencias o cadenas aceptadas
+    LazyStats cache;                        // Solo en las pruebas del AFD perezoso
+};
+
+bool leerOpciones(int argc, char* argv[], Opciones& opciones) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hayValor = i + 1 < argc;
+        if (arg == "--tamanos" && hayValor) {
+            opciones.tamanos.clear();
+            stringstream lista(argv[++i]);
+            string tamano;
+            while (getline(lista, tamano, ',')) opciones.tamanos.push_back(max(1ULL, strtoull(tamano.c_str(), nullptr, 10)));
+        } else if (arg == "--semilla" && hayValor) {
+            opciones.semilla = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--warmup" && hayValor) {
+            opciones.warmup = atoi(argv[++i]);
+        } else if (arg == "--iteraciones" && hayValor) {
+            opciones.iteraciones = max(1, atoi(argv[++i]));
+        } else if (arg == "--expresion" && hayValor) {
+            opciones.expresion = argv[++i];
+        } else if (arg == "--buscar" && hayValor) {
+            opciones.buscar = argv[++i];
+        } else if (arg == "--alfabeto" && hayValor) {
+            opciones.alfabeto = argv[++i];
+        } else if (arg == "--megabytes" && hayValor) {
+            opciones.megabytes = max(1ULL, strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--cadenas" && hayValor) {
+            opciones.cadenas = max(4ULL, strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--explosion" && hayValor) {
+            opciones.explosion = max(1, atoi(argv[++i]));
+        } else if (arg == "--memoria" && hayValor) {
+            opciones.memoria = strtoull(argv[++i], nullptr, 10);
+        } else {
+            cerr << "Opcion desconocida: " << arg << endl;
+            return false;
+        }
+    }
+    return !opciones.tamanos.empty() && !opciones.alfabeto.empty();
+}
+
+/*
+Expresión aleatoria de casi simbolos caracteres sobre el alfabeto {a, b, c}: una estrella,
+una unión o una concatenación (implícita) de dos expresiones cuyos tamaños se reparten al azar. Los tamaños se
+reparten en partes parecidas, así que la profundidad de la recursión queda cerca de log(simbolos).
+*/
+void generarExpresion(mt19937_64& azar, size_t simbolos, string& expresion) {
+    if (simbolos < 3) {
+        expresion += "abc"[azar() % 3];
+        return;
+    }
+    if (simbolos < 5) {         // Dos símbolos sin paréntesis: quien la contiene ya la encierra en los suyos
+        expresion += "abc"[azar() % 3];
+        if (azar() % 2) expresion += '|';
+        expresion += "abc"[azar() % 3];
+        return;
+    }
+    int operador = azar() % 5;
+    if (operador == 0) {
+        expresion += '(';
+        generarExpresion(azar, simbolos - 3, expresion);
+        expresion += ")*";
+        return;
+    }
+    size_t resto = operador <= 2 ? simbolos - 2 : simbolos - 3;     // La concatenación no ocupa caracter
+    size_t izquierda = resto / 4 + azar() % (resto / 2 + 1);
+    expresion += '(';
+    generarExpresion(azar, izquierda, expresion);
+    if (operador > 2) expresion += '|';
+    generarExpresion(azar, resto - izquierda, expresion);
+    expresion += ')';
+}
+
+int main(int argc, char* argv[]) {
+    Opciones opciones;
+    if (!leerOpciones(argc, argv, opciones)) {
+        return 1;
+    }
+
+    mt19937_64 azar(opciones.semilla);
+    vector<Resultado> resultados;
+    for (size_t tamano : opciones.tamanos) {
+        string expresion;
+        generarExpresion(azar, tamano, expresion);
+
+        Regex regex;
+        string error;
+        size_t posicion;
+        Automata automata;
+        NFA nfa;
+        Resultado r;
+        r.simbolos = expresion.size();
+        r.analisis = calcularEstadisticas(repetir(opciones.warmup, opciones.iteraciones, [&] {
+            parseRegex(expresion, regex, error, posicion);
+        }));
+        r.afn = calcularEstadisticas(repetir(opciones.warmup, opciones.iteraciones, [&] {
+            automata = constructAutomata(regex);
+        }));
+        r.csr = calcularEstadisticas(repetir(opciones.warmup, opciones.iteraciones, [&] {
+            nfa = compileNFA(automata);
+        }));
+        r.estados = automata.numStates;
+        r.transiciones = automata.edges.size();
+        resultados.push_back(r);
+    }
+
+    //Reconocedor: un texto grande y muchas cadenas cortas (de 8 a 64 bytes) sobre el alfabeto
+    DFA dfa, dfaBuscar;
+    if (!regexToDFA(opciones.expresion, opciones.alfabeto, dfa) || !regexToDFA(opciones.buscar, opciones.alfabeto, dfaBuscar)) {
+        return 1;
+    }
+    Matcher matcher(dfa), buscador(dfaBuscar);
+    string texto(opciones.megabytes << 20, ' ');
+    for (char& c : texto) c = opciones.alfabeto[azar() % opciones.alfabeto.size()];
+    string cortas;
+    vector<string_view> cadenas;
+    vector<size_t> largos(opciones.cadenas);
+    for (size_t& largo : largos) largo = 8 + azar() % 57;
+    for (size_t largo : largos) {
+        for (size_t k = 0; k < largo; k++) cortas += opciones.alfabeto[azar() % opciones.alfabeto.size()];
+    }
+    for (size_t i = 0, inicio = 0; i < largos.size(); inicio += largos[i++]) {
+        cadenas.push_back(string_view(cortas).substr(inicio, largos[i]));
+    }
+
+    vector<Velocidad> velocidades;
+    size_t resultado = 0;
+    auto medirVelocidad = [&](const string& prueba, size_t bytes, auto funcion) {
+        vector<double> tiempos = repetir(opciones.warmup, opciones.iteraciones, funcion);
+        velocidades.push_back({prueba, bytes, calcularEstadisticas(tiempos), resultado, {}});
+    };
+    medirVelocidad("match", texto.size(), [&] {
+        resultado = matcher.match(texto);
+    });
+    medirVelocidad("stream_64KB", texto.size(), [&] {
+        StreamMatcher stream(matcher);
+        for (size_t i = 0; i < texto.size(); i += 1 << 16) stream.feed(string_view(texto).substr(i, 1 << 16));
+        resultado = stream.accepted();
+    });
+    medirVelocidad("find_all", texto.size(), [&] {
+        resultado = buscador.find_all(texto).size();
+    });
+    vector<uint8_t> individuales(cadenas.size()), lote(cadenas.size());
+    medirVelocidad("cortas_una_por_una", cortas.size(), [&] {
+        for (size_t i = 0; i < cadenas.size(); i++) individuales[i] = matcher.match(cadenas[i]);
+        resultado = count(individuales.begin(), individuales.end(), 1);
+    });
+    medirVelocidad("cortas_match_batch", cortas.size(), [&] {
+        matcher.match_batch(cadenas.data(), cadenas.size(), lote.data());
+        resultado = count(lote.begin(), lote.end(), 1);
+    });
+    int diferentes = individuales != lote;
+
+    //AFD perezoso: con la misma expresión casi todo debe ser acierto; con la explosión la caché se
+    //llena y se vacía, así que se mide sobre el primer MB del texto. Los contadores son de todas las corridas
+    Regex regex;
+    string error;
+    size_t posicion;
+    parseRegex(opciones.expresion, regex, error, posicion);
+    NFA nfa = compileNFA(constructAutomata(regex));
+    LazyDFA perezoso(nfa, opciones.alfabeto, opciones.memoria);
+    medirVelocidad("perezoso_match", texto.size(), [&] {
+        resultado = perezoso.match(texto);
+    });
+    velocidades.back().cache = perezoso.stats;
+    diferentes += velocidades.back().resultado != velocidades[0].resultado;
+
+    string explosion = "(a|b)*a";
+    for (int i = 0; i < opciones.explosion; i++) explosion += "(a|b)";
+    parseRegex(explosion, regex, error, posicion);
+    NFA nfaExplosion = compileNFA(constructAutomata(regex));
+    LazyDFA perezosoExplosion(nfaExplosion, "ab", opciones.memoria);
+    string_view primerMB = string_view(texto).substr(0, 1 << 20);
+    medirVelocidad("perezoso_explosion", primerMB.size(), [&] {
+        resultado = perezosoExplosion.match(primerMB);
+    });
+    velocidades.back().cache = perezosoExplosion.stats;
+
+    // ns por símbolo a partir de la mediana en ms
+    auto porSimbolo = [](const Estadisticas& e, size_t simbolos) { return e.mediana * 1e6 / simbolos; };
+
+    cout << "{\n";
+    cout << "  \"semilla\": " << opciones.semilla << ",\n";
+    cout << "  \"warmup\": " << opciones.warmup << ",\n";
+    cout << "  \"iteraciones\": " << opciones.iteraciones << ",\n";
+    cout << "  \"resultados\": [\n";
+    for (size_t i = 0; i < resultados.size(); i++) {
+        const Resultado& r = resultados[i];
+        cout << "    {\"simbolos\": " << r.simbolos << ", \"estados\": " << r.estados << ", \"transiciones\": " << r.transiciones
+             << ", \"analisis_ms\": " << r.analisis.mediana << ", \"afn_ms\": " << r.afn.mediana << ", \"afn_mad_ms\": " << r.afn.mad
+             << ", \"csr_ms\": " << r.csr.mediana
+             << ", \"ns_simbolo\": {\"analisis\": " << porSimbolo(r.analisis, r.simbolos) << ", \"afn\": " << porSimbolo(r.afn, r.simbolos)
+             << ", \"csr\": " << porSimbolo(r.csr, r.simbolos) << "}}" << (i + 1 < resultados.size() ? "," : "") << "\n";
+    }
+    cout << "  ],\n";
+    cout << "  \"reconocedor\": {\"expresion\": \"" << opciones.expresion << "\", \"buscar\": \"" << opciones.buscar
+         << "\", \"estados\": " << dfa.numStates << ", \"clases\": " << matcher.numClasses() << ", \"cadenas\": " << cadenas.size() << "},\n";
+    cout << "  \"velocidades\": [\n";
+    for (size_t i = 0; i < velocidades.size(); i++) {
+        const Velocidad& v = velocidades[i];
+        cout << "    {\"prueba\": \"" << v.prueba << "\", \"bytes\": " << v.bytes << ", \"mediana_ms\": " << v.tiempo.mediana
+             << ", \"mad_ms\": " << v.tiempo.mad << ", \"gb_s\": " << v.bytes / (v.tiempo.mediana / 1000.0) / 1e9
+             << ", \"resultado\": " << v.resultado;
+        if (v.cache.hits + v.cache.misses > 0) {
+            cout << ", \"cache\": {\"tasa_aciertos\": " << v.cache.hitRate() << ", \"fallos\": " << v.cache.misses
+                 << ", \"estados_creados\": " << v.cache.states << ", \"vaciados\": " << v.cache.flushes << "}";
+        }
+        cout << "}" << (i + 1 < velocidades.size() ? "," : "") << "\n";
+    }
+    cout << "  ],\n";
+    cout << "  \"speedup_batch\": " << velocidades[3].tiempo.mediana / velocidades[4].tiempo.mediana << ",\n";
+    cout << "  \"perezoso\": {\"explosion\": \"" << explosion << "\", \"memoria\": " << opciones.memoria
+         << ", \"capacidad_estados\": " << perezosoExplosion.capacity() << "},\n";
+    cout << "  \"diferentes\": " << diferentes << "\n}" << endl;
+
+    return diferentes == 0 ? 0 : 1;
+}
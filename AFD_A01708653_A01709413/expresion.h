@@ -0,0 +1,471 @@
+// ==========================================================================
+// File: expresion.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene el analizador de expresiones regulares por descenso
+//              recursivo que usa automata.h. Produce un árbol de sintaxis y entiende
+//              concatenación implícita, unión (|), los cuantificadores *, +, ? y {m,n},
+//              clases de caracteres con rangos y negación ([a-z], [^"]), el punto (cualquier
+//              byte menos el salto de línea), escapes (\n, \t, \xHH, \d, \w, \s, \. ...) y la
+//              cadena vacía (una alternativa vacía, () o ε). Los errores dicen en qué
+//              posición de la expresión están; también es un error una expresión demasiado
+//              anidada o cuyo AFN sería demasiado grande.
+// ===========================================================================================
+
+#ifndef EXPRESION_H
+#define EXPRESION_H
+
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum NodeKind { NODE_EPSILON, NODE_SET, NODE_CONCAT, NODE_UNION, NODE_STAR, NODE_PLUS, NODE_OPTIONAL, NODE_REPEAT };
+
+// Máximo de {m,n}: cada repetición es una copia del operando en el AFN
+const int MAX_REPEAT = 1000;
+// Máxima profundidad del árbol (paréntesis y cuantificadores anidados): tanto el analizador como
+// buildFragment lo recorren con recursión, y sin límite una expresión muy anidada agota la pila
+const int MAX_NESTING = 1000;
+// Máximo de transiciones del AFN (unos 1.5 GB entre el depósito y el formato CSR)
+const uint64_t MAX_NFA_EDGES = 1ULL << 26;
+
+/*
+Nodo del árbol. Los hijos de una concatenación o una unión forman una lista (firstChild y después
+nextSibling), así que una expresión larga no se vuelve un árbol muy profundo. Los cuantificadores
+tienen un solo hijo. states y edges son lo que ocupará el nodo en el AFN de Thompson.
+*/
+struct RegexNode {
+    NodeKind kind;
+    int firstChild = -1;
+    int nextSibling = -1;
+    int set = -1;                   // NODE_SET: índice en Regex::sets
+    int min = 0, max = 0;           // NODE_REPEAT; max = -1 es sin límite
+    uint64_t states = 0, edges = 0;
+    int height = 1;                 // Niveles del subárbol que empieza en este nodo
+};
+
+struct Regex {
+    std::vector<RegexNode> nodes;
+    std::vector<std::bitset<256>> sets;       // Bytes que acepta cada NODE_SET
+    int root = -1;
+};
+
+class RegexParser {
+public:
+    /*
+    Analiza text completo. Si hay un error regresa false y deja en error el mensaje y en errorPosition
+    la posición (desde 0) en la que se detectó.
+    */
+    bool parse(const std::string& text, Regex& regex, std::string& error, size_t& errorPosition) {
+        input = &text;
+        position = 0;
+        out = &regex;
+        regex = Regex();
+        failed = false;
+        message.clear();
+        depth = 0;
+
+        int root = parseUnion();
+        if (!failed && position < text.size()) {
+            fail(text[position] == ')' ? "')' sin '(' que le corresponda" : "caracter inesperado");
+        }
+        if (!failed) {
+            position = 0;
+            checkSize(root);
+        }
+        if (failed) {
+            error = message;
+            errorPosition = failPosition;
+            return false;
+        }
+        regex.root = root;
+        return true;
+    }
+
+private:
+    bool atEnd() const {
+        return position >= input->size();
+    }
+
+    char peek() const {
+        return (*input)[position];
+    }
+
+    void fail(const std::string& what) {
+        if (failed) return;
+        failed = true;
+        message = what;
+        failPosition = position;
+    }
+
+    /*
+    Falla si el nodo ya es demasiado grande o demasiado profundo. Se llama en cuanto se arma cada nodo
+    compuesto, así que el error queda en la posición donde la expresión se pasó del límite. Las cuentas
+    de estados y transiciones se topan en 2^40, así que siempre caben en 64 bits.
+    */
+    bool checkSize(int height, uint64_t states, uint64_t edges) {
+        if (height > MAX_NESTING) {
+            fail("mas de " + std::to_string(MAX_NESTING) + " niveles de anidamiento");
+        } else if (states >= UINT32_MAX) {
+            fail("el AFN tendria mas de 2^32 estados");
+        } else if (edges > MAX_NFA_EDGES) {
+            fail("el AFN tendria mas de " + std::to_string(MAX_NFA_EDGES) + " transiciones");
+        }
+        return !failed;
+    }
+
+    bool checkSize(int node) {
+        const RegexNode& n = out->nodes[node];
+        return checkSize(n.height, n.states, n.edges);
+    }
+
+    int addNode(NodeKind kind) {
+        out->nodes.push_back(RegexNode());
+        out->nodes.back().kind = kind;
+        return out->nodes.size() - 1;
+    }
+
+    int addSet(const std::bitset<256>& bytes) {
+        int node = addNode(NODE_SET);
+        out->sets.push_back(bytes);
+        out->nodes[node].set = out->sets.size() - 1;
+        out->nodes[node].states = 2;
+        out->nodes[node].edges = bytes.count();
+        return node;
+    }
+
+    int addEpsilon() {
+        int node = addNode(NODE_EPSILON);
+        out->nodes[node].states = 2;
+        out->nodes[node].edges = 1;
+        return node;
+    }
+
+    // union := concat ('|' concat)*
+    int parseUnion() {
+        int first = parseConcat();
+        if (failed || atEnd() || peek() != '|') return first;
+
+        int node = addNode(NODE_UNION);
+        out->nodes[node].firstChild = first;
+        out->nodes[node].states = 2 + out->nodes[first].states;
+        out->nodes[node].edges = 2 + out->nodes[first].edges;
+        out->nodes[node].height = out->nodes[first].height + 1;
+        int last = first;
+        while (!failed && !atEnd() && peek() == '|') {
+            position++;
+            int child = parseConcat();
+            if (failed) break;
+            out->nodes[last].nextSibling = child;
+            last = child;
+            out->nodes[node].states += out->nodes[child].states;
+            out->nodes[node].edges += 2 + out->nodes[child].edges;
+            out->nodes[node].height = std::max(out->nodes[node].height, out->nodes[child].height + 1);
+            if (!checkSize(node)) break;
+        }
+        return node;
+    }
+
+    // concat := repeat*; sin ningún operando es la cadena vacía
+    int parseConcat() {
+        int first = -1, last = -1, count = 0, height = 0;
+        uint64_t states = 0, edges = 0;
+        while (!failed && !atEnd() && peek() != '|' && peek() != ')') {
+            int child = parseRepeat();
+            if (failed) break;
+            if (first < 0) {
+                first = child;
+            } else {
+                out->nodes[last].nextSibling = child;
+            }
+            last = child;
+            count++;
+            states += out->nodes[child].states;
+            edges += out->nodes[child].edges + 1;
+            height = std::max(height, out->nodes[child].height);
+            if (!checkSize(height + 1, states, edges)) break;
+        }
+        if (failed) return -1;
+        if (count == 0) return addEpsilon();
+        if (count == 1) return first;
+        int node = addNode(NODE_CONCAT);
+        out->nodes[node].firstChild = first;
+        out->nodes[node].states = states;
+        out->nodes[node].edges = edges;
+        out->nodes[node].height = height + 1;
+        checkSize(node);
+        return node;
+    }
+
+    // repeat := atom ('*' | '+' | '?' | '{m}' | '{m,}' | '{m,n}')*
+    int parseRepeat() {
+        int node = parseAtom();
+        while (!failed && !atEnd()) {
+            char c = peek();
+            NodeKind kind;
+            int min = 0, max = 0;
+            if (c == '*') {
+                kind = NODE_STAR;
+            } else if (c == '+') {
+                kind = NODE_PLUS;
+            } else if (c == '?') {
+                kind = NODE_OPTIONAL;
+            } else if (c == '{') {
+                kind = NODE_REPEAT;
+            } else {
+                break;
+            }
+            size_t start = position;
+            if (kind == NODE_REPEAT) {
+                if (!parseBounds(min, max)) return -1;
+            } else {
+                position++;
+            }
+            int quantified = addNode(kind);
+            RegexNode& q = out->nodes[quantified];
+            const RegexNode& child = out->nodes[node];
+            q.firstChild = node;
+            q.min = min;
+            q.max = max;
+            if (kind == NODE_REPEAT) {
+                // min copias seguidas y después max - min opcionales (o una estrella si no hay límite)
+                // Se topa en 2^40 para que repeticiones anidadas no desborden la cuenta
+                uint64_t copies = max < 0 ? min + 1 : max;
+                q.states = std::min<uint64_t>(copies * (child.states + 2) + 2, 1ULL << 40);
+                q.edges = std::min<uint64_t>(copies * (child.edges + 4) + 1, 1ULL << 40);
+            } else {
+                q.states = child.states + 2;
+                q.edges = child.edges + 4;
+            }
+            q.height = child.height + 1;
+            node = quantified;
+            size_t end = position;
+            position = start;
+            if (!checkSize(node)) return -1;
+            position = end;
+        }
+        return node;
+    }
+
+    // {m}, {m,} o {m,n}; deja position después de '}'
+    bool parseBounds(int& min, int& max) {
+        size_t open = position++;
+        auto number = [&](int& value) {
+            if (atEnd() || !isdigit((unsigned char) peek())) return false;
+            value = 0;
+            while (!atEnd() && isdigit((unsigned char) peek())) {
+                value = value * 10 + (peek() - '0');
+                if (value > MAX_REPEAT) {
+                    fail("repeticion mayor a " + std::to_string(MAX_REPEAT));
+                    return false;
+                }
+                position++;
+            }
+            return true;
+        };
+        if (!number(min)) {
+            fail("se esperaba un numero en la repeticion");
+            return false;
+        }
+        max = min;
+        if (!atEnd() && peek() == ',') {
+            position++;
+            max = -1;
+            if (!atEnd() && peek() != '}' && !number(max)) {
+                fail("se esperaba un numero o '}' en la repeticion");
+                return false;
+            }
+        }
+        if (failed) return false;
+        if (atEnd() || peek() != '}') {
+            fail("falta '}' de la repeticion que empieza en " + std::to_string(open));
+            return false;
+        }
+        if (max >= 0 && max < min) {
+            position = open;
+            fail("en {m,n} n es menor que m");
+            return false;
+        }
+        position++;
+        return true;
+    }
+
+    // atom := '(' union ')' | '[' clase ']' | '.' | '\' escape | ε | literal
+    int parseAtom() {
+        char c = peek();
+        if (c == '*' || c == '+' || c == '?' || c == '{') {
+            fail(std::string("'") + c + "' sin nada que repetir");
+            return -1;
+        }
+        if (c == '(') {
+            size_t open = position++;
+            if (++depth > MAX_NESTING) {
+                position = open;
+                fail("mas de " + std::to_string(MAX_NESTING) + " parentesis anidados");
+                return -1;
+            }
+            int node = parseUnion();
+            depth--;
+            if (failed) return -1;
+            if (atEnd()) {
+                position = open;
+                fail("'(' sin ')' que le corresponda");
+                return -1;
+            }
+            position++;
+            return node;
+        }
+        if (c == '[') {
+            return parseClass();
+        }
+        std::bitset<256> bytes;
+        if (c == '.') {
+            bytes.set();
+            bytes.reset('\n');
+            position++;
+        } else if (c == '\\') {
+            if (!parseEscape(bytes)) return -1;
+        } else if (input->compare(position, 2, "ε") == 0) {
+            position += 2;
+            return addEpsilon();
+        } else {
+            bytes.set((unsigned char) c);
+            position++;
+        }
+        return addSet(bytes);
+    }
+
+    /*
+    Escape que empieza en la posición actual ('\'): agrega a bytes lo que representa. Fuera de los
+    escapes con nombre, cualquier caracter que no sea letra ni número se representa a sí mismo.
+    */
+    bool parseEscape(std::bitset<256>& bytes) {
+        size_t start = position++;
+        if (atEnd()) {
+            position = start;
+            fail("'\\' al final de la expresion");
+            return false;
+        }
+        char c = peek();
+        position++;
+        auto range = [&](int from, int to) {
+            for (int b = from; b <= to; b++) bytes.set(b);
+        };
+        std::bitset<256> word, space;
+        for (int b = '0'; b <= '9'; b++) word.set(b);
+        for (int b = 'a'; b <= 'z'; b++) word.set(b);
+        for (int b = 'A'; b <= 'Z'; b++) word.set(b);
+        word.set('_');
+        for (char s : std::string(" \t\n\r\f\v")) space.set((unsigned char) s);
+        switch (c) {
+            case 'n': bytes.set('\n'); break;
+            case 't': bytes.set('\t'); break;
+            case 'r': bytes.set('\r'); break;
+            case 'f': bytes.set('\f'); break;
+            case 'v': bytes.set('\v'); break;
+            case '0': bytes.set(0); break;
+            case 'd': range('0', '9'); break;
+            case 'D': range(0, 255); for (int b = '0'; b <= '9'; b++) bytes.reset(b); break;
+            case 'w': bytes |= word; break;
+            case 'W': bytes |= ~word; break;
+            case 's': bytes |= space; break;
+            case 'S': bytes |= ~space; break;
+            case 'x': {
+                int value = 0;
+                for (int k = 0; k < 2; k++) {
+                    if (atEnd() || !isxdigit((unsigned char) peek())) {
+                        fail("se esperaban dos digitos hexadecimales despues de \\x");
+                        return false;
+                    }
+                    char h = peek();
+                    value = value * 16 + (isdigit((unsigned char) h) ? h - '0' : tolower(h) - 'a' + 10);
+                    position++;
+                }
+                bytes.set(value);
+                break;
+            }
+            default:
+                if (isalnum((unsigned char) c)) {
+                    position = start;
+                    fail(std::string("escape desconocido \\") + c);
+                    return false;
+                }
+                bytes.set((unsigned char) c);
+        }
+        return true;
+    }
+
+    // clase := '[' '^'? elemento+ ']', elemento := byte ('-' byte)? | escape de clase (\d, \w, \s ...)
+    int parseClass() {
+        size_t open = position++;
+        bool negated = !atEnd() && peek() == '^';
+        if (negated) position++;
+        std::bitset<256> bytes;
+        bool first = true;
+        while (true) {
+            if (atEnd()) {
+                position = open;
+                fail("'[' sin ']' que le corresponda");
+                return -1;
+            }
+            if (peek() == ']' && !first) break;
+            first = false;
+
+            std::bitset<256> item;
+            int low;
+            if (!classByte(item, low)) return -1;
+            // Un rango: byte '-' byte, donde el '-' no es el último de la clase
+            if (low >= 0 && position + 1 < input->size() && peek() == '-' && (*input)[position + 1] != ']') {
+                size_t dash = position++;
+                std::bitset<256> upperItem;
+                int high;
+                if (!classByte(upperItem, high)) return -1;
+                if (high < 0 || high < low) {
+                    position = dash;
+                    fail("rango invalido en la clase");
+                    return -1;
+                }
+                for (int b = low; b <= high; b++) bytes.set(b);
+            } else {
+                bytes |= item;
+            }
+        }
+        position++;
+        if (negated) bytes.flip();
+        return addSet(bytes);
+    }
+
+    // Un elemento de una clase; value es el byte si es uno solo y -1 si es un escape como \d
+    bool classByte(std::bitset<256>& item, int& value) {
+        if (peek() == '\\') {
+            if (!parseEscape(item)) return false;
+        } else {
+            item.set((unsigned char) peek());
+            position++;
+        }
+        value = -1;
+        if (item.count() == 1) {
+            for (value = 0; !item.test(value); value++) {}
+        }
+        return true;
+    }
+
+    const std::string* input = nullptr;
+    size_t position = 0;
+    Regex* out = nullptr;
+    bool failed = false;
+    int depth = 0;                  // Paréntesis abiertos en la posición actual
+    std::string message;
+    size_t failPosition = 0;
+};
+
+// Analiza text; si hay un error lo escribe en error con su posición
+inline bool parseRegex(const std::string& text, Regex& regex, std::string& error, size_t& errorPosition) {
+    RegexParser parser;
+    return parser.parse(text, regex, error, errorPosition);
+}
+
+#endif
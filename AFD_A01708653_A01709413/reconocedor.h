@@ -0,0 +1,220 @@
+// ==========================================================================
+// File: reconocedor.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene el reconocedor que se compila a partir del AFD mínimo
+//              de afd.h: saber si una cadena completa pertenece al lenguaje (match), buscar
+//              todas las coincidencias en un texto (find_all), reconocer una entrada que
+//              llega en pedazos (StreamMatcher) y reconocer muchas cadenas cortas a la vez
+//              intercalando sus recorridos (match_batch). Los bytes que se comportan igual
+//              en todos los estados comparten una clase, así que la tabla tiene solo una
+//              columna por clase.
+// ===========================================================================================
+
+#ifndef RECONOCEDOR_H
+#define RECONOCEDOR_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "afd.h"
+
+// Una coincidencia de find_all: el texto [begin, end)
+struct Match {
+    size_t begin;
+    size_t end;
+};
+
+/*
+AFD listo para recorrer. Los estados se renumeran: el 0 sigue siendo el muerto, después van los que no
+aceptan y al final los que aceptan, así que aceptar es solo comparar contra acceptFrom. Cada estado
+se guarda ya multiplicado por el número de clases (su desplazamiento en la tabla), y avanzar un byte
+es una suma y una lectura: state = next[state + classOf[b]].
+*/
+class Matcher {
+public:
+    explicit Matcher(const DFA& dfa) {
+        // Clases de bytes: dos columnas del AFD con las mismas transiciones en todos los estados son una sola
+        std::vector<int> classOfColumn(dfa.numSymbols, -1);
+        std::vector<int> columnOfClass;
+        for (int c = 0; c < dfa.numSymbols; c++) {
+            for (size_t k = 0; k < columnOfClass.size() && classOfColumn[c] < 0; k++) {
+                bool same = true;
+                for (int q = 0; q < dfa.numStates && same; q++) {
+                    same = dfa.table[q * dfa.numSymbols + c] == dfa.table[q * dfa.numSymbols + columnOfClass[k]];
+                }
+                if (same) classOfColumn[c] = k;
+            }
+            if (classOfColumn[c] < 0) {
+                classOfColumn[c] = columnOfClass.size();
+                columnOfClass.push_back(c);
+            }
+        }
+        classes = columnOfClass.size();
+        for (int b = 0; b < 256; b++) classOf[b] = classOfColumn[dfa.column[b]];
+
+        std::vector<uint32_t> newId(dfa.numStates);
+        uint32_t id = 1;
+        for (int accepts = 0; accepts < 2; accepts++) {
+            if (accepts) acceptFrom = id * classes;
+            for (int q = 1; q < dfa.numStates; q++) {
+                if (dfa.accepting[q] == accepts) newId[q] = id++;
+            }
+        }
+        next.assign(dfa.numStates * classes, 0);
+        for (int q = 0; q < dfa.numStates; q++) {
+            for (uint32_t k = 0; k < classes; k++) {
+                next[newId[q] * classes + k] = newId[dfa.table[q * dfa.numSymbols + columnOfClass[k]]] * classes;
+            }
+        }
+        start = newId[dfa.start] * classes;
+    }
+
+    uint32_t numClasses() const {
+        return classes;
+    }
+
+    uint32_t step(uint32_t state, unsigned char b) const {
+        return next[state + classOf[b]];
+    }
+
+    bool accepting(uint32_t state) const {
+        return state >= acceptFrom;
+    }
+
+    /*
+    Recorre input desde state. El ciclo interno no tiene más saltos que el suyo: el estado muerto
+    se revisa solo cada bloque de 64 bytes para dejar de leer una entrada que ya no puede aceptar.
+    */
+    uint32_t run(uint32_t state, std::string_view input) const {
+        const unsigned char* p = (const unsigned char*) input.data();
+        size_t n = input.size(), i = 0;
+        const uint32_t* table = next.data();
+        while (i < n) {
+            size_t end = i + 64 < n ? i + 64 : n;
+            for (; i + 4 <= end; i += 4) {
+                state = table[state + classOf[p[i]]];
+                state = table[state + classOf[p[i + 1]]];
+                state = table[state + classOf[p[i + 2]]];
+                state = table[state + classOf[p[i + 3]]];
+            }
+            for (; i < end; i++) state = table[state + classOf[p[i]]];
+            if (state == 0) break;
+        }
+        return state;
+    }
+
+    // La cadena completa pertenece al lenguaje
+    bool match(std::string_view input) const {
+        return accepting(run(start, input));
+    }
+
+    /*
+    Coincidencias que no se enciman, de izquierda a derecha y cada una la más larga posible desde su
+    inicio (como un analizador léxico). Desde cada posición se avanza hasta caer en el estado muerto
+    recordando el último estado de aceptación; si no hubo ninguna coincidencia no vacía se sigue en
+    la posición siguiente.
+    */
+    std::vector<Match> find_all(std::string_view buffer) const {
+        std::vector<Match> matches;
+        const unsigned char* p = (const unsigned char*) buffer.data();
+        size_t n = buffer.size(), i = 0;
+        while (i < n) {
+            uint32_t state = start;
+            size_t last = i;
+            for (size_t j = i; j < n; j++) {
+                state = next[state + classOf[p[j]]];
+                if (state == 0) break;
+                if (state >= acceptFrom) last = j + 1;
+            }
+            if (last > i) {
+                matches.push_back({i, last});
+                i = last;
+            } else {
+                i++;
+            }
+        }
+        return matches;
+    }
+
+    /*
+    results[i] = match(inputs[i]). Las cadenas se toman de 4 en 4 y se recorren juntas hasta que se
+    acaba la más corta: los cuatro recorridos no dependen entre sí, así que el procesador puede tener
+    las cuatro lecturas de la tabla en vuelo al mismo tiempo en vez de esperar una por una. Lo que le
+    queda a cada una se termina por separado.
+    */
+    void match_batch(const std::string_view* inputs, size_t count, uint8_t* results) const {
+        const uint32_t* table = next.data();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const unsigned char* p0 = (const unsigned char*) inputs[i].data();
+            const unsigned char* p1 = (const unsigned char*) inputs[i + 1].data();
+            const unsigned char* p2 = (const unsigned char*) inputs[i + 2].data();
+            const unsigned char* p3 = (const unsigned char*) inputs[i + 3].data();
+            size_t common = std::min(std::min(inputs[i].size(), inputs[i + 1].size()), std::min(inputs[i + 2].size(), inputs[i + 3].size()));
+            uint32_t s0 = start, s1 = start, s2 = start, s3 = start;
+            for (size_t j = 0; j < common; j++) {
+                s0 = table[s0 + classOf[p0[j]]];
+                s1 = table[s1 + classOf[p1[j]]];
+                s2 = table[s2 + classOf[p2[j]]];
+                s3 = table[s3 + classOf[p3[j]]];
+            }
+            results[i] = accepting(run(s0, inputs[i].substr(common)));
+            results[i + 1] = accepting(run(s1, inputs[i + 1].substr(common)));
+            results[i + 2] = accepting(run(s2, inputs[i + 2].substr(common)));
+            results[i + 3] = accepting(run(s3, inputs[i + 3].substr(common)));
+        }
+        for (; i < count; i++) results[i] = match(inputs[i]);
+    }
+
+    uint32_t start = 0;
+
+private:
+    uint32_t classes = 1;
+    uint32_t acceptFrom = 0;
+    uint8_t classOf[256];
+    std::vector<uint32_t> next;
+};
+
+/*
+Reconocimiento de una entrada que llega en pedazos: guarda el estado entre llamadas, así que
+alimentarlo con los pedazos en orden da lo mismo que llamar match con la entrada completa.
+*/
+class StreamMatcher {
+public:
+    explicit StreamMatcher(const Matcher& matcher) : matcher(matcher), state(matcher.start) {}
+
+    void feed(std::string_view chunk) {
+        if (state != 0) state = matcher.run(state, chunk);
+        consumed += chunk.size();
+    }
+
+    // Lo que se ha recibido hasta ahora pertenece al lenguaje
+    bool accepted() const {
+        return matcher.accepting(state);
+    }
+
+    // Ya no hay forma de aceptar sin importar lo que llegue después
+    bool dead() const {
+        return state == 0;
+    }
+
+    size_t bytes() const {
+        return consumed;
+    }
+
+    void reset() {
+        state = matcher.start;
+        consumed = 0;
+    }
+
+private:
+    const Matcher& matcher;
+    uint32_t state;
+    size_t consumed = 0;
+};
+
+#endif
@@ -0,0 +1,133 @@
+// ===========================================================================================
+// File: benchmark.cpp
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Pruebas de rendimiento de las pruebas de primalidad de primalidad.h sobre
+//              candidatos dispersos (números aleatorios de 32 bits). Compara es_primo
+//              contra es_primo_batch en cada nivel SIMD que soporte el procesador, verifica
+//              que todas den el mismo resultado y reporta candidatos por segundo y ciclos
+//              por candidato en JSON (con la mediana, el MAD y el intervalo de confianza).
+//              To compile: g++ -std=c++17 -O2 benchmark.cpp -o benchmark
+//              y después  ./benchmark [--candidatos N] [--maximo M] [--semilla S]
+//                         [--warmup N] [--iteraciones N]
+// ===========================================================================================
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <climits>
+#include "../comun/perfilador.h"
+#include "primalidad.h"
+
+using namespace std;
+
+struct Opciones {
+    size_t candidatos = 1 << 20;
+    uint32_t maximo = INT_MAX;          // Por omisión, el rango original de es_primo (int)
+    uint64_t semilla = 1;
+    int warmup = 1;
+    int iteraciones = 5;
+};
+
+struct Resultado {
+    string nombre;
+    Estadisticas tiempo;                // ms por pasada sobre todos los candidatos
+    double candidatosPorSegundo;
+    double ciclosPorCandidato;
+    size_t primos;
+};
+
+bool leerOpciones(int argc, char* argv[], Opciones& opciones) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hayValor = i + 1 < argc;
+        if (arg == "--candidatos" && hayValor) {
+            opciones.candidatos = max(1ULL, strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--maximo" && hayValor) {
+            opciones.maximo = (uint32_t) min<unsigned long long>(UINT32_MAX, strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--semilla" && hayValor) {
+            opciones.semilla = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--warmup" && hayValor) {
+            opciones.warmup = atoi(argv[++i]);
+        } else if (arg == "--iteraciones" && hayValor) {
+            opciones.iteraciones = max(1, atoi(argv[++i]));
+        } else {
+            cerr << "Opcion desconocida: " << arg << endl;
+            return false;
+        }
+    }
+    if (opciones.maximo < 2) opciones.maximo = 2;
+    return true;
+}
+
+/*
+Corre probar() sobre todos los candidatos con las corridas de calentamiento y las iteraciones medidas
+de las opciones. probar llena el arreglo de resultados.
+*/
+template <typename Prueba>
+Resultado medir(const string& nombre, size_t candidatos, const Opciones& opciones, vector<uint8_t>& primos, Prueba probar) {
+    vector<double> ciclos;
+    vector<double> tiempos = repetir(opciones.warmup, opciones.iteraciones, [&] {
+        Cronometro cronometro;
+        probar();
+        ciclos.push_back(cronometro.ciclos());
+    });
+    ciclos.erase(ciclos.begin(), ciclos.begin() + opciones.warmup);
+    Estadisticas tiempo = calcularEstadisticas(tiempos);
+    return {nombre, tiempo, candidatos / (tiempo.mediana / 1000.0), calcularEstadisticas(ciclos).mediana / candidatos,
+            (size_t) count(primos.begin(), primos.end(), 1)};
+}
+
+int main(int argc, char* argv[]) {
+    Opciones opciones;
+    if (!leerOpciones(argc, argv, opciones)) {
+        return 1;
+    }
+
+    mt19937_64 azar(opciones.semilla);
+    uniform_int_distribution<uint32_t> distribucion(2, opciones.maximo);
+    vector<uint32_t> candidatos(opciones.candidatos);
+    for (uint32_t& candidato : candidatos) candidato = distribucion(azar);
+
+    vector<Resultado> resultados;
+    vector<uint8_t> referencia(candidatos.size()), primos(candidatos.size());
+
+    resultados.push_back(medir("es_primo", candidatos.size(), opciones, referencia, [&] {
+        for (size_t i = 0; i < candidatos.size(); i++) referencia[i] = es_primo(candidatos[i]);
+    }));
+
+    int diferentes = 0;
+    vector<const char*> niveles = {"escalar"};
+    if (__builtin_cpu_supports("sse4.1")) niveles.push_back("sse4.1");
+    if (__builtin_cpu_supports("avx2")) niveles.push_back("avx2");
+    for (const char* nivel : niveles) {
+        FuncionPrimalidad funcion = funcion_primalidad(nivel);
+        resultados.push_back(medir(string("es_primo_batch/") + nivel, candidatos.size(), opciones, primos, [&] {
+            funcion(candidatos.data(), candidatos.size(), primos.data());
+        }));
+        if (primos != referencia) {
+            cerr << "Resultado diferente en " << nivel << endl;
+            diferentes++;
+        }
+    }
+
+    cout << "{\n";
+    cout << "  \"candidatos\": " << candidatos.size() << ", \"maximo\": " << opciones.maximo
+         << ", \"semilla\": " << opciones.semilla << ", \"nivel_simd\": \"" << nivel_simd() << "\",\n";
+    cout << "  \"warmup\": " << opciones.warmup << ",\n";
+    cout << "  \"iteraciones\": " << opciones.iteraciones << ",\n";
+    cout << "  \"resultados\": [\n";
+    for (size_t i = 0; i < resultados.size(); i++) {
+        const Resultado& r = resultados[i];
+        cout << "    {\"prueba\": \"" << r.nombre << "\", \"mediana_ms\": " << r.tiempo.mediana
+             << ", \"mad_ms\": " << r.tiempo.mad << ", \"ic95_ms\": [" << r.tiempo.icInferior << ", " << r.tiempo.icSuperior << "]"
+             << ", \"candidatos_s\": " << r.candidatosPorSegundo << ", \"ciclos_candidato\": " << r.ciclosPorCandidato
+             << ", \"primos\": " << r.primos << ", \"speedup\": " << resultados[0].tiempo.mediana / r.tiempo.mediana << "}"
+             << (i + 1 < resultados.size() ? "," : "") << "\n";
+    }
+    cout << "  ],\n";
+    cout << "  \"diferentes\": " << diferentes << "\n}" << endl;
+
+    return diferentes == 0 ? 0 : 1;
+}
@@ -0,0 +1,274 @@
+// ==========================================================================
+// File: cache_primos.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene la caché de primos en disco que usa sum_primos.cpp
+//              con --cache: un mapa de bits de los impares con la suma acumulada de los
+//              primos al inicio de cada bloque. Las corridas siguientes abren el archivo
+//              con mmap y responden la suma de los primos en [a, b) recorriendo a lo más
+//              un bloque por extremo; si se pide un límite mayor solo se criba lo que
+//              falta y se agrega al final del archivo. Cada bloque lleva su propio checksum,
+//              que se verifica solo cuando una consulta lo lee, así que abrir la caché no
+//              cuesta más aunque el archivo sea muy grande.
+// ===========================================================================================
+
+#ifndef CACHE_PRIMOS_H
+#define CACHE_PRIMOS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "criba.h"
+
+// Se incrementa cuando cambia el formato del archivo; una caché de otra versión se regenera
+const uint32_t VERSION_CACHE_PRIMOS = 3;
+// Números que cubre cada bloque: 8192 impares, un bit por impar (1 KB de bits por bloque)
+const uint64_t NUMEROS_POR_BLOQUE = 16384;
+const uint64_t PALABRAS_POR_BLOQUE = NUMEROS_POR_BLOQUE / 128;
+
+// Cabecera al inicio del archivo (64 bytes, para que los bloques queden alineados a 16)
+struct CabeceraCache {
+    char magico[8];             // "PRIMOSBT"
+    uint32_t version;
+    uint32_t numerosPorBloque;
+    uint64_t bloques;           // Bloques válidos: la caché cubre [0, bloques * NUMEROS_POR_BLOQUE)
+    uint64_t checksum;          // FNV-1a de los campos de arriba (ver checksumCabecera)
+    uint64_t reservado[4];
+};
+
+/*
+Cada bloque guarda la suma de todos los primos menores a su inicio (incluyendo al 2) y el mapa de
+bits de sus impares: el bit k del bloque que empieza en base representa a base + 2k + 1.
+*/
+struct BloqueCache {
+    uint128 sumaPrevia;
+    uint64_t bits[PALABRAS_POR_BLOQUE];
+    uint64_t checksum;          // FNV-1a de sumaPrevia y bits (ver checksumBloque)
+    uint64_t reservado;         // Para que el bloque mida un múltiplo de 16
+};
+
+const uint64_t FNV_INICIAL = 14695981039346656037ULL;
+
+// FNV-1a por palabras de 64 bits
+inline uint64_t fnv1a(uint64_t hash, const void* datos, size_t bytes) {
+    const uint64_t* palabras = (const uint64_t*) datos;
+    for (size_t i = 0; i < bytes / 8; i++) {
+        hash = (hash ^ palabras[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+La cabecera y cada bloque tienen su propio checksum. El de la cabecera (mágico, versión, números por
+bloque y bloques) se revisa al abrir; el de un bloque, cada vez que una consulta lo usa.
+*/
+inline uint64_t checksumCabecera(const CabeceraCache& cabecera) {
+    return fnv1a(FNV_INICIAL, &cabecera, offsetof(CabeceraCache, checksum));
+}
+
+inline uint64_t checksumBloque(const BloqueCache& bloque) {
+    return fnv1a(FNV_INICIAL, &bloque, offsetof(BloqueCache, checksum));
+}
+
+class CachePrimos {
+public:
+    ~CachePrimos() {
+        cerrar();
+    }
+
+    /*
+    Abre (o crea) la caché en ruta y se asegura de que cubra [0, limite). Si el archivo no existe,
+    es de otra versión o el checksum de su cabecera no coincide, se regenera completo; si cubre menos
+    de lo pedido se criban solo los bloques que faltan. Los bloques no se leen al abrir: se verifican
+    cuando se consultan (ver suma). reutilizados y generados dicen cuántos bloques se leyeron
+    del archivo y cuántos se calcularon.
+    */
+    bool preparar(const std::string& ruta, uint64_t limite, uint64_t& reutilizados, uint64_t& generados) {
+        cerrar();
+        fd = open(ruta.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            std::cerr << "Error al abrir la cache: " << ruta << std::endl;
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            std::cerr << "Error al leer el tamano de la cache: " << ruta << std::endl;
+            cerrar();
+            return false;
+        }
+
+        CabeceraCache leida;
+        uint64_t validos = 0;
+        if ((size_t) info.st_size >= sizeof(CabeceraCache) && pread(fd, &leida, sizeof(leida), 0) == sizeof(leida)) {
+            // Se divide en lugar de multiplicar: con bloques corrupto, bytesPara(bloques) podría desbordarse
+            uint64_t caben = ((uint64_t) info.st_size - sizeof(CabeceraCache)) / sizeof(BloqueCache);
+            bool compatible = memcmp(leida.magico, "PRIMOSBT", 8) == 0 && leida.version == VERSION_CACHE_PRIMOS &&
+                              leida.numerosPorBloque == NUMEROS_POR_BLOQUE && leida.bloques <= caben;
+            if (compatible && checksumCabecera(leida) == leida.checksum && mapear(bytesPara(leida.bloques))) {
+                validos = leida.bloques;
+            }
+            if (validos == 0) {
+                std::cerr << "La cache " << ruta << " es de otra version o esta danada; se regenera" << std::endl;
+            }
+        }
+
+        uint64_t necesarios = std::max<uint64_t>(1, (limite + NUMEROS_POR_BLOQUE - 1) / NUMEROS_POR_BLOQUE);
+        reutilizados = std::min(validos, necesarios);
+        generados = 0;
+        if (necesarios <= validos) {
+            return mapear(bytesPara(validos));
+        }
+
+        // Los bloques nuevos continúan la suma del último que ya estaba; si ese está dañado se regenera todo
+        if (validos > 0 && !bloqueValido(validos - 1)) {
+            std::cerr << "La cache " << ruta << " esta danada; se regenera" << std::endl;
+            validos = 0;
+            reutilizados = 0;
+        }
+
+        // Se agranda el archivo y se escriben los bloques nuevos; la cabecera se actualiza al final,
+        // así que si el proceso se interrumpe a la mitad el archivo sigue describiendo solo lo válido
+        if (ftruncate(fd, bytesPara(necesarios)) != 0 || !mapear(bytesPara(necesarios))) {
+            std::cerr << "Error al agrandar la cache: " << ruta << std::endl;
+            return false;
+        }
+        generar(validos, necesarios);
+        generados = necesarios - validos;
+
+        CabeceraCache* cabecera = (CabeceraCache*) mapa;
+        memset(cabecera, 0, sizeof(CabeceraCache));
+        memcpy(cabecera->magico, "PRIMOSBT", 8);
+        cabecera->version = VERSION_CACHE_PRIMOS;
+        cabecera->numerosPorBloque = NUMEROS_POR_BLOQUE;
+        cabecera->bloques = necesarios;
+        cabecera->checksum = checksumCabecera(*cabecera);
+        msync(mapa, tamano, MS_SYNC);
+        return true;
+    }
+
+    // Hasta qué número responde la caché: [0, cubierto())
+    uint64_t cubierto() const {
+        return cantidad * NUMEROS_POR_BLOQUE;
+    }
+
+    /*
+    Deja en suma la suma de los primos menores a x (x <= cubierto()): la suma guardada al inicio de su
+    bloque más los primos del bloque que quedan antes de x, así que recorre a lo más
+    PALABRAS_POR_BLOQUE palabras. Un x mayor se recorta a cubierto() para nunca leer fuera del mapa.
+    Regresa false si el checksum del bloque no coincide.
+    */
+    bool suma_menores(uint64_t x, uint128& suma) const {
+        x = std::min(x, cubierto());
+        suma = 0;
+        if (x <= 2) return true;
+        uint64_t b = (x - 1) / NUMEROS_POR_BLOQUE;         // Bloque del último número que cuenta
+        uint64_t base = b * NUMEROS_POR_BLOQUE;
+        uint64_t cuantos = std::min(NUMEROS_POR_BLOQUE / 2, (x - base) / 2);     // Impares base + 2k + 1 < x
+        const BloqueCache& bloque = bloques[b];
+        if (!bloqueValido(b)) return false;
+
+        suma = bloque.sumaPrevia + (b == 0 ? 2 : 0);
+        for (uint64_t w = 0; w * 64 < cuantos; w++) {
+            uint64_t palabra = bloque.bits[w];
+            if (cuantos - w * 64 < 64) palabra &= (1ULL << (cuantos - w * 64)) - 1;
+            while (palabra) {
+                suma += base + 2 * (64 * w + __builtin_ctzll(palabra)) + 1;
+                palabra &= palabra - 1;
+            }
+        }
+        return true;
+    }
+
+    /*
+    Deja en resultado la suma de los primos en [a, b), con b <= cubierto() (los extremos mayores se
+    recortan). Solo lee los bloques de a y de b; regresa false si alguno de los dos está dañado.
+    */
+    bool suma(uint64_t a, uint64_t b, uint128& resultado) const {
+        a = std::min(a, cubierto());
+        b = std::min(b, cubierto());
+        resultado = 0;
+        if (a >= b) return true;
+        uint128 hastaB, hastaA;
+        if (!suma_menores(b, hastaB) || !suma_menores(a, hastaA)) return false;
+        resultado = hastaB - hastaA;
+        return true;
+    }
+
+    // Marca el archivo como inválido (después de encontrar un bloque dañado) para que preparar lo regenere
+    void invalidar() {
+        if (!mapa) return;
+        memset(mapa, 0, sizeof(CabeceraCache));
+        msync(mapa, sizeof(CabeceraCache), MS_SYNC);
+    }
+
+    void cerrar() {
+        if (mapa) munmap(mapa, tamano);
+        if (fd >= 0) close(fd);
+        mapa = nullptr;
+        fd = -1;
+        cantidad = 0;
+    }
+
+private:
+    bool bloqueValido(uint64_t b) const {
+        return bloques[b].checksum == checksumBloque(bloques[b]);
+    }
+
+    static uint64_t bytesPara(uint64_t numeroBloques) {
+        return sizeof(CabeceraCache) + numeroBloques * sizeof(BloqueCache);
+    }
+
+    bool mapear(size_t bytes) {
+        if (mapa) munmap(mapa, tamano);
+        mapa = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapa == MAP_FAILED) {
+            mapa = nullptr;
+            return false;
+        }
+        tamano = bytes;
+        bloques = (BloqueCache*) ((char*) mapa + sizeof(CabeceraCache));
+        cantidad = (bytes - sizeof(CabeceraCache)) / sizeof(BloqueCache);
+        return true;
+    }
+
+    // Criba los bloques [desde, hasta) y llena sus bits, sus sumas previas y sus checksums
+    void generar(uint64_t desde, uint64_t hasta) {
+        uint128 total = 0;
+        if (desde > 0) suma_menores(desde * NUMEROS_POR_BLOQUE, total);     // preparar ya verificó ese bloque
+        memset(bloques + desde, 0, (hasta - desde) * sizeof(BloqueCache));
+        uint64_t actual = desde;
+        bloques[actual].sumaPrevia = total;
+
+        CribaSegmentada criba(hasta * NUMEROS_POR_BLOQUE);
+        criba.recorrer(desde * NUMEROS_POR_BLOQUE, hasta * NUMEROS_POR_BLOQUE, [&](uint64_t primo) {
+            while (primo >= (actual + 1) * NUMEROS_POR_BLOQUE) {
+                bloques[++actual].sumaPrevia = total;
+            }
+            total += primo;
+            if (primo == 2) return;     // El 2 no tiene bit; suma_menores lo agrega en el bloque 0
+            uint64_t k = (primo - actual * NUMEROS_POR_BLOQUE) / 2;
+            bloques[actual].bits[k / 64] |= 1ULL << (k % 64);
+        });
+        while (actual + 1 < hasta) {
+            bloques[++actual].sumaPrevia = total;
+        }
+        for (uint64_t b = desde; b < hasta; b++) {
+            bloques[b].checksum = checksumBloque(bloques[b]);
+        }
+    }
+
+    int fd = -1;
+    void* mapa = nullptr;
+    size_t tamano = 0;
+    BloqueCache* bloques = nullptr;
+    uint64_t cantidad = 0;
+};
+
+#endif
@@ -0,0 +1,139 @@
+// ==========================================================================
+// File: criba.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene la criba de Eratóstenes segmentada que usa
+//              sum_primos.cpp como motor alternativo a la división por tentativa.
+//              Solo guarda los impares, un bit por número, en segmentos del tamaño
+//              de la caché, así que la memoria no depende del límite.
+// ===========================================================================================
+
+#ifndef CRIBA_H
+#define CRIBA_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+typedef unsigned __int128 uint128;
+
+// Bytes de cada segmento: 32 KB caben en la caché L1 de datos y cubren 512K números
+const size_t BYTES_SEGMENTO = 32 * 1024;
+
+// Convierte un entero de 128 bits a texto (iostream no sabe imprimirlos)
+inline std::string a_texto(uint128 valor) {
+    if (valor == 0) return "0";
+    std::string texto;
+    while (valor > 0) {
+        texto += char('0' + (int) (valor % 10));
+        valor /= 10;
+    }
+    std::reverse(texto.begin(), texto.end());
+    return texto;
+}
+
+// Raíz cuadrada entera exacta: el mayor r tal que r * r <= n
+inline uint64_t raiz_entera(uint64_t n) {
+    uint64_t r = (uint64_t) __builtin_sqrtl((long double) n);
+    while (r > 0 && (uint128) r * r > n) r--;
+    while ((uint128) (r + 1) * (r + 1) <= n) r++;
+    return r;
+}
+
+/*
+Primos impares menores o iguales a limite con una criba simple. Se usa para obtener los primos base
+(hasta la raíz del límite), que son pocos: para 10^12 son menos de 80 mil.
+*/
+inline std::vector<uint32_t> primos_base(uint32_t limite) {
+    std::vector<uint32_t> primos;
+    if (limite < 3) return primos;
+    std::vector<bool> compuesto(limite / 2 + 1, false);     // compuesto[i] representa 2i + 1
+    for (uint64_t i = 1; i <= limite / 2; i++) {
+        if (compuesto[i]) continue;
+        uint64_t p = 2 * i + 1;
+        primos.push_back((uint32_t) p);
+        for (uint64_t m = p * p / 2; m <= limite / 2; m += p) {
+            compuesto[m] = true;
+        }
+    }
+    return primos;
+}
+
+/*
+Criba segmentada sobre el rango [inicio, fin). Cada segmento representa solo números impares
+(bit k = inicioSegmento + 2k) y se tacha con los primos base; después se recorren los bits que
+quedaron encendidos. La memoria usada es la de un segmento más los primos base.
+*/
+class CribaSegmentada {
+public:
+    // Prepara los primos base necesarios para cribar cualquier rango con fin <= limite
+    explicit CribaSegmentada(uint64_t limite) : base(primos_base((uint32_t) raiz_entera(limite))), segmento(BYTES_SEGMENTO / 8) {}
+
+    /*
+    Llama a visitar(primo) para cada primo en [inicio, fin), en orden. Incluye al 2 si está en el
+    rango. fin debe ser menor o igual al límite con el que se construyó la criba.
+    */
+    template <typename Visitante>
+    void recorrer(uint64_t inicio, uint64_t fin, Visitante visitar) {
+        if (inicio <= 2 && fin > 2) visitar(2);
+        std::vector<uint64_t> proximo;      // Siguiente múltiplo impar a tachar de cada primo base
+        uint64_t desde = std::max<uint64_t>(inicio, 3) | 1;     // Primer impar del rango
+        const uint64_t numerosPorSegmento = 2 * 64 * segmento.size();
+
+        for (uint64_t bajo = desde; bajo < fin; bajo += numerosPorSegmento) {
+            uint64_t alto = std::min(fin, bajo + numerosPorSegmento);      // [bajo, alto)
+            size_t bits = (alto - bajo + 1) / 2;
+            size_t palabras = (bits + 63) / 64;
+            std::fill(segmento.begin(), segmento.begin() + palabras, ~0ULL);
+            if (bits % 64) segmento[palabras - 1] = (1ULL << (bits % 64)) - 1;
+
+            for (size_t j = 0; j < base.size(); j++) {
+                uint64_t p = base[j];
+                if (p * p >= alto) break;
+                // El primer segmento calcula el primer múltiplo impar de p en el rango (sin bajar
+                // de p*p); los siguientes continúan donde se quedó el anterior, sin dividir
+                if (j == proximo.size()) {
+                    uint64_t m = std::max(p * p, (bajo + p - 1) / p * p);
+                    if (m % 2 == 0) m += p;
+                    proximo.push_back(m);
+                }
+                uint64_t k = (proximo[j] - bajo) / 2;
+                for (; k < bits; k += p) {
+                    segmento[k / 64] &= ~(1ULL << (k % 64));
+                }
+                proximo[j] = bajo + 2 * k;
+            }
+            if (bajo == 1) segmento[0] &= ~1ULL;    // El 1 no es primo
+
+            for (size_t w = 0; w < palabras; w++) {
+                uint64_t palabra = segmento[w];
+                while (palabra) {
+                    int k = __builtin_ctzll(palabra);
+                    visitar(bajo + 2 * (64 * w + k));
+                    palabra &= palabra - 1;
+                }
+            }
+        }
+    }
+
+    // Suma de los primos en [inicio, fin)
+    uint128 suma(uint64_t inicio, uint64_t fin) {
+        uint128 total = 0;
+        recorrer(inicio, fin, [&total](uint64_t primo) { total += primo; });
+        return total;
+    }
+
+private:
+    std::vector<uint32_t> base;
+    std::vector<uint64_t> segmento;
+};
+
+// Suma de todos los primos menores a limite usando la criba segmentada
+inline uint128 suma_primos_criba(uint64_t limite) {
+    CribaSegmentada criba(limite);
+    return criba.suma(0, limite);
+}
+
+#endif
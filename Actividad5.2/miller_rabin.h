@@ -0,0 +1,188 @@
+// ==========================================================================
+// File: miller_rabin.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene la prueba de primalidad para enteros de 64 bits
+//              que usa sum_primos.cpp con el motor miller: una rueda módulo 210 y
+//              divisiones por primos pequeños descartan a la mayoría de los compuestos
+//              y el resto pasa por Miller-Rabin determinista con las 7 bases conocidas,
+//              con multiplicación de Montgomery en 128 bits. Sirve para sumar primos en
+//              ventanas [lo, hi) muy por encima de 2^32 sin cribar desde cero.
+// ===========================================================================================
+
+#ifndef MILLER_RABIN_H
+#define MILLER_RABIN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+typedef unsigned __int128 uint128;
+
+/*
+Aritmética de Montgomery módulo un n impar: los números se guardan como a * 2^64 mod n y así cada
+multiplicación modular se hace con tres multiplicaciones de 64 bits, sin dividir entre n.
+*/
+class Montgomery {
+public:
+    explicit Montgomery(uint64_t n) : n(n) {
+        inverso = n;                            // Newton: cada paso duplica los bits correctos
+        for (int i = 0; i < 5; i++) inverso *= 2 - n * inverso;
+        uno = (uint64_t) (((uint128) 1 << 64) % n);
+        r2 = (uint64_t) ((uint128) uno * uno % n);
+        menosUno = n - uno;
+    }
+
+    // a * b / 2^64 mod n, con a y b en forma de Montgomery
+    uint64_t multiplicar(uint64_t a, uint64_t b) const {
+        return reducir((uint128) a * b);
+    }
+
+    uint64_t convertir(uint64_t a) const {
+        return multiplicar(a % n, r2);
+    }
+
+    uint64_t potencia(uint64_t base, uint64_t exponente) const {
+        uint64_t resultado = uno;
+        while (exponente) {
+            if (exponente & 1) resultado = multiplicar(resultado, base);
+            base = multiplicar(base, base);
+            exponente >>= 1;
+        }
+        return resultado;
+    }
+
+    const uint64_t n;
+    uint64_t uno;       // 1 en forma de Montgomery
+    uint64_t menosUno;  // n - 1 en forma de Montgomery
+
+private:
+    // t / 2^64 mod n. m se elige para que t - m * n sea múltiplo de 2^64, así que la parte baja se
+    // cancela y basta con restar las partes altas (sin desbordar aunque n esté cerca de 2^64)
+    uint64_t reducir(uint128 t) const {
+        uint64_t m = (uint64_t) t * inverso;
+        uint64_t alto = (uint64_t) (t >> 64);
+        uint64_t resta = (uint64_t) (((uint128) m * n) >> 64);
+        return alto >= resta ? alto - resta : alto - resta + n;
+    }
+
+    uint64_t inverso;   // n * inverso = 1 módulo 2^64
+    uint64_t r2;        // 2^128 mod n
+};
+
+/*
+Miller-Rabin para n impar mayor a 2. Con las bases {2, 325, 9375, 28178, 450775, 9780504, 1795265022}
+la respuesta es exacta para todo n < 2^64.
+*/
+inline bool miller_rabin(uint64_t n) {
+    static const uint64_t bases[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+    Montgomery mont(n);
+    uint64_t d = n - 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+
+    for (uint64_t base : bases) {
+        uint64_t a = base % n;
+        if (a == 0) continue;
+        uint64_t x = mont.potencia(mont.convertir(a), d);
+        if (x == mont.uno || x == mont.menosUno) continue;
+        bool compuesto = true;
+        for (int r = 1; r < s && compuesto; r++) {
+            x = mont.multiplicar(x, x);
+            if (x == mont.menosUno) compuesto = false;
+        }
+        if (compuesto) return false;
+    }
+    return true;
+}
+
+// Residuos módulo 210 = 2*3*5*7 que no son múltiplos de 2, 3, 5 ni 7 (48 de 210)
+struct Rueda {
+    std::array<uint8_t, 48> residuos;
+    std::array<bool, 210> coprimo;
+
+    Rueda() : residuos(), coprimo() {
+        int k = 0;
+        for (int r = 0; r < 210; r++) {
+            coprimo[r] = r % 2 && r % 3 && r % 5 && r % 7;
+            if (coprimo[r]) residuos[k++] = r;
+        }
+    }
+};
+
+inline const Rueda& rueda() {
+    static const Rueda tabla;
+    return tabla;
+}
+
+// Los 42 primos de 11 a 199 con los que se divide antes de Miller-Rabin, como inverso módulo 2^64:
+// p divide a n exactamente cuando n * inverso (módulo 2^64) <= (2^64 - 1) / p
+struct DivisorPequeno {
+    uint64_t primo;
+    uint64_t inverso;
+    uint64_t maximo;
+};
+
+inline const std::array<DivisorPequeno, 42>& divisores_pequenos() {
+    static const std::array<DivisorPequeno, 42> tabla = [] {
+        std::array<DivisorPequeno, 42> divisores{};
+        std::size_t k = 0;
+        for (uint64_t p = 11; k < divisores.size(); p += 2) {
+            bool primo = true;
+            for (uint64_t q = 3; q * q <= p; q += 2) {
+                if (p % q == 0) primo = false;
+            }
+            if (!primo) continue;
+            uint64_t inverso = p;
+            for (int i = 0; i < 5; i++) inverso *= 2 - p * inverso;
+            divisores[k++] = {p, inverso, UINT64_MAX / p};
+        }
+        return divisores;
+    }();
+    return tabla;
+}
+
+/*
+Primalidad para n que ya pasó la rueda (no es múltiplo de 2, 3, 5 ni 7 y es mayor a 7). Primero
+divide entre los primos pequeños, que descarta cerca de la mitad de lo que queda, y solo el resto
+pasa por Miller-Rabin.
+*/
+inline bool es_primo_tras_rueda(uint64_t n) {
+    if (n < 121) return n > 1;      // Sin factores de la rueda y menor a 11^2
+    for (const DivisorPequeno& d : divisores_pequenos()) {
+        if (d.primo * d.primo > n) return true;
+        if (n * d.inverso <= d.maximo) return false;
+    }
+    return miller_rabin(n);
+}
+
+// Prueba de primalidad exacta para cualquier entero de 64 bits
+inline bool es_primo_64(uint64_t n) {
+    if (n < 11) return n == 2 || n == 3 || n == 5 || n == 7;
+    if (!rueda().coprimo[n % 210]) return false;
+    return es_primo_tras_rueda(n);
+}
+
+/*
+Suma de los primos en [lo, hi). Solo prueba los números que caen en los 48 residuos de la rueda, es
+decir, menos de la cuarta parte del rango.
+*/
+inline uint128 suma_primos_miller_rabin(uint64_t lo, uint64_t hi) {
+    uint128 suma = 0;
+    for (uint64_t p : {2, 3, 5, 7}) {
+        if (lo <= p && p < hi) suma += p;
+    }
+    const Rueda& r = rueda();
+    // Se usa uint128 para que base + residuo no desborde cerca de 2^64
+    for (uint128 base = lo - lo % 210; base < hi; base += 210) {
+        for (uint8_t residuo : r.residuos) {
+            uint128 x = base + residuo;
+            if (x < lo || x <= 7) continue;
+            if (x >= hi) break;
+            if (es_primo_tras_rueda((uint64_t) x)) suma += x;
+        }
+    }
+    return suma;
+}
+
+#endif
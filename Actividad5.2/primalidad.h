@@ -0,0 +1,246 @@
+// ==========================================================================
+// File: primalidad.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene las pruebas de primalidad por división de
+//              sum_primos.cpp: la función original es_primo y es_primo_batch, que
+//              prueba muchos candidatos de 32 bits a la vez con instrucciones SIMD
+//              (AVX2 u SSE4.1, según lo que tenga el procesador) y una versión
+//              escalar cuando no hay ninguna de las dos.
+// ===========================================================================================
+
+#ifndef PRIMALIDAD_H
+#define PRIMALIDAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <immintrin.h>
+
+/*
+Recibe un entero, empieza el ciclo en 2 (porque el 1 naturalmente es primo). Mientras el cuadrado del número sea menor
+o igual a n, el ciclo aumenta 1 y se checa si n es divisible entre j (residuo 0), si esto es correcto, no es primo (false)
+ya que un número primo nada más es divisible entre sí mismo y entre el 1. El cuadrado se calcula en 64 bits para que
+no se desborde cerca de 2^31 (como pasaba con int), y mientras n quepa en 32 bits se divide en 32 bits, que es más rápido.
+*/
+inline bool es_primo(uint64_t n) {
+    if (n <= UINT32_MAX) {
+        uint32_t m = (uint32_t) n;
+        for (uint32_t j = 2; (uint64_t) j * j <= m; j++) {
+            if (m % j == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    for (uint64_t j = 2; j * j <= n; j++) {
+        if (n % j == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+Datos de cada primo impar p < 2^16 para saber si divide a un n de 32 bits sin dividir: si inverso
+es el inverso de p módulo 2^32, p divide a n exactamente cuando n * inverso (módulo 2^32) es menor
+o igual a (2^32 - 1) / p. Con estos primos basta para cualquier candidato de 32 bits.
+*/
+struct DivisorPrimo {
+    uint32_t inverso;
+    uint32_t maximo;        // (2^32 - 1) / p
+    uint32_t cuadrado;      // p * p, para saber cuándo ya no hace falta seguir probando
+    uint32_t primo;
+};
+
+inline const std::vector<DivisorPrimo>& divisores_primos() {
+    static const std::vector<DivisorPrimo> tabla = [] {
+        std::vector<DivisorPrimo> divisores;
+        std::vector<bool> compuesto(1 << 16, false);
+        for (uint32_t p = 3; p < (1 << 16); p += 2) {
+            if (compuesto[p]) continue;
+            for (uint32_t m = p * p; m < (1 << 16); m += 2 * p) compuesto[m] = true;
+            uint32_t inverso = p;                       // Newton: cada paso duplica los bits correctos
+            for (int i = 0; i < 4; i++) inverso *= 2 - p * inverso;
+            divisores.push_back({inverso, UINT32_MAX / p, p * p, p});
+        }
+        return divisores;
+    }();
+    return tabla;
+}
+
+/*
+Versión escalar de es_primo_batch. Usa la misma prueba de divisibilidad con el inverso que las
+versiones SIMD para que las tres den exactamente el mismo resultado.
+*/
+inline void es_primo_batch_escalar(const uint32_t* candidatos, size_t n, uint8_t* primos) {
+    const std::vector<DivisorPrimo>& divisores = divisores_primos();
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x = candidatos[i];
+        bool primo = x == 2 || (x >= 3 && (x & 1));
+        if (primo) {
+            for (const DivisorPrimo& d : divisores) {
+                if (d.cuadrado > x) break;
+                if (x * d.inverso <= d.maximo) {
+                    primo = false;
+                    break;
+                }
+            }
+        }
+        primos[i] = primo;
+    }
+}
+
+// Candidatos que siguen sin divisor: su posición en el arreglo original y su valor
+struct Pendientes {
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> valores;
+};
+
+/*
+Una etapa de las versiones SIMD: prueba a los pendientes, 8 a la vez, con los divisores [desde, hasta).
+Cada carril sigue activo mientras no tenga divisor y el cuadrado del primo actual no lo supere, y el
+lote termina antes si ya no queda ningún carril activo. Los que encontraron un divisor se marcan como
+compuestos y los que siguen activos al final pasan a la siguiente etapa. Los carriles sobrantes se
+rellenan con 0, que nunca queda activo. No hay comparaciones sin signo, así que x <= y se calcula como
+min(x, y) == x.
+*/
+__attribute__((target("avx2")))
+inline void etapa_primalidad_avx2(const Pendientes& pendientes, size_t desde, size_t hasta, uint8_t* primos, Pendientes& siguiente) {
+    const std::vector<DivisorPrimo>& divisores = divisores_primos();
+    const __m256i cero = _mm256_setzero_si256();
+    for (size_t i = 0; i < pendientes.valores.size(); i += 8) {
+        uint32_t lote[8] = {0};
+        size_t cuantos = pendientes.valores.size() - i < 8 ? pendientes.valores.size() - i : 8;
+        for (size_t k = 0; k < cuantos; k++) lote[k] = pendientes.valores[i + k];
+        __m256i x = _mm256_loadu_si256((const __m256i*) lote);
+        __m256i activo = _mm256_xor_si256(_mm256_cmpeq_epi32(x, cero), _mm256_set1_epi32(-1));
+        __m256i compuesto = cero;
+
+        for (size_t j = desde; j < hasta; j++) {
+            const DivisorPrimo& d = divisores[j];
+            __m256i menor = _mm256_cmpeq_epi32(_mm256_min_epu32(x, _mm256_set1_epi32(d.cuadrado - 1)), x);
+            activo = _mm256_andnot_si256(menor, activo);
+            __m256i producto = _mm256_mullo_epi32(x, _mm256_set1_epi32(d.inverso));
+            __m256i divisible = _mm256_cmpeq_epi32(_mm256_min_epu32(producto, _mm256_set1_epi32(d.maximo)), producto);
+            divisible = _mm256_and_si256(divisible, activo);
+            compuesto = _mm256_or_si256(compuesto, divisible);
+            activo = _mm256_andnot_si256(divisible, activo);
+            if (_mm256_testz_si256(activo, activo)) break;
+        }
+
+        int mascaraCompuesto = _mm256_movemask_ps(_mm256_castsi256_ps(compuesto));
+        int mascaraActivo = _mm256_movemask_ps(_mm256_castsi256_ps(activo));
+        for (size_t k = 0; k < cuantos; k++) {
+            if ((mascaraCompuesto >> k) & 1) primos[pendientes.indices[i + k]] = 0;
+            if ((mascaraActivo >> k) & 1) {
+                siguiente.indices.push_back(pendientes.indices[i + k]);
+                siguiente.valores.push_back(lote[k]);
+            }
+        }
+    }
+}
+
+// Lo mismo que etapa_primalidad_avx2 con 4 carriles de SSE4.1
+__attribute__((target("sse4.1")))
+inline void etapa_primalidad_sse41(const Pendientes& pendientes, size_t desde, size_t hasta, uint8_t* primos, Pendientes& siguiente) {
+    const std::vector<DivisorPrimo>& divisores = divisores_primos();
+    const __m128i cero = _mm_setzero_si128();
+    for (size_t i = 0; i < pendientes.valores.size(); i += 4) {
+        uint32_t lote[4] = {0};
+        size_t cuantos = pendientes.valores.size() - i < 4 ? pendientes.valores.size() - i : 4;
+        for (size_t k = 0; k < cuantos; k++) lote[k] = pendientes.valores[i + k];
+        __m128i x = _mm_loadu_si128((const __m128i*) lote);
+        __m128i activo = _mm_xor_si128(_mm_cmpeq_epi32(x, cero), _mm_set1_epi32(-1));
+        __m128i compuesto = cero;
+
+        for (size_t j = desde; j < hasta; j++) {
+            const DivisorPrimo& d = divisores[j];
+            __m128i menor = _mm_cmpeq_epi32(_mm_min_epu32(x, _mm_set1_epi32(d.cuadrado - 1)), x);
+            activo = _mm_andnot_si128(menor, activo);
+            __m128i producto = _mm_mullo_epi32(x, _mm_set1_epi32(d.inverso));
+            __m128i divisible = _mm_cmpeq_epi32(_mm_min_epu32(producto, _mm_set1_epi32(d.maximo)), producto);
+            divisible = _mm_and_si128(divisible, activo);
+            compuesto = _mm_or_si128(compuesto, divisible);
+            activo = _mm_andnot_si128(divisible, activo);
+            if (_mm_testz_si128(activo, activo)) break;
+        }
+
+        int mascaraCompuesto = _mm_movemask_ps(_mm_castsi128_ps(compuesto));
+        int mascaraActivo = _mm_movemask_ps(_mm_castsi128_ps(activo));
+        for (size_t k = 0; k < cuantos; k++) {
+            if ((mascaraCompuesto >> k) & 1) primos[pendientes.indices[i + k]] = 0;
+            if ((mascaraActivo >> k) & 1) {
+                siguiente.indices.push_back(pendientes.indices[i + k]);
+                siguiente.valores.push_back(lote[k]);
+            }
+        }
+    }
+}
+
+typedef void (*EtapaPrimalidad)(const Pendientes&, size_t, size_t, uint8_t*, Pendientes&);
+
+/*
+Versiones SIMD de es_primo_batch. Los carriles de un lote avanzan juntos, así que si se probara cada
+lote contra toda la tabla, un solo primo obligaría a los otros carriles a esperarlo hasta el final.
+Por eso la tabla se recorre en etapas que duplican su tamaño (32, 64, 128, ... divisores) y entre
+etapas se vuelven a juntar solo los candidatos que siguen sin decidir: la primera etapa descarta a la
+mayoría de los compuestos y las últimas trabajan casi solo con primos.
+*/
+inline void es_primo_batch_por_etapas(const uint32_t* candidatos, size_t n, uint8_t* primos, EtapaPrimalidad etapa) {
+    const std::vector<DivisorPrimo>& divisores = divisores_primos();
+    Pendientes pendientes, siguiente;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x = candidatos[i];
+        bool impar = x >= 3 && (x & 1);
+        primos[i] = x == 2 || impar;
+        if (impar) {
+            pendientes.indices.push_back(i);
+            pendientes.valores.push_back(x);
+        }
+    }
+    for (size_t desde = 0, hasta = 32; desde < divisores.size() && !pendientes.valores.empty(); desde = hasta, hasta *= 2) {
+        siguiente.indices.clear();
+        siguiente.valores.clear();
+        etapa(pendientes, desde, std::min(hasta, divisores.size()), primos, siguiente);
+        std::swap(pendientes, siguiente);
+    }
+}
+
+inline void es_primo_batch_avx2(const uint32_t* candidatos, size_t n, uint8_t* primos) {
+    es_primo_batch_por_etapas(candidatos, n, primos, etapa_primalidad_avx2);
+}
+
+inline void es_primo_batch_sse41(const uint32_t* candidatos, size_t n, uint8_t* primos) {
+    es_primo_batch_por_etapas(candidatos, n, primos, etapa_primalidad_sse41);
+}
+
+typedef void (*FuncionPrimalidad)(const uint32_t*, size_t, uint8_t*);
+
+// Nombre de la implementación que usa es_primo_batch en este procesador
+inline const char* nivel_simd() {
+    if (__builtin_cpu_supports("avx2")) return "avx2";
+    if (__builtin_cpu_supports("sse4.1")) return "sse4.1";
+    return "escalar";
+}
+
+// Implementación de es_primo_batch por nombre ("avx2", "sse4.1" o "escalar")
+inline FuncionPrimalidad funcion_primalidad(const char* nivel) {
+    std::string nombre = nivel;
+    if (nombre == "avx2") return es_primo_batch_avx2;
+    if (nombre == "sse4.1") return es_primo_batch_sse41;
+    return es_primo_batch_escalar;
+}
+
+/*
+Escribe en primos[i] 1 si candidatos[i] es primo y 0 si no (0 y 1 no son primos). La implementación
+se elige una sola vez, la primera vez que se llama, según lo que soporte el procesador.
+*/
+inline void es_primo_batch(const uint32_t* candidatos, size_t n, uint8_t* primos) {
+    static const FuncionPrimalidad funcion = funcion_primalidad(nivel_simd());
+    funcion(candidatos, n, primos);
+}
+
+#endif
@@ -5,77 +5,141 @@
 // Description: Este archivo contiene el código para obtener toda la suma de los números
 //              primos menores a 5,000,000 (cinco millones) de manera secuencial y de
 //              manera paralela. Ambos resultados deben dar 838,596,693,108
-//              To compile: g++ -std=c++11 sum_primos.cpp -lpthread -o app   y después  ./app
+//              Hay cuatro motores: división por tentativa (el original), la misma división
+//              probando varios candidatos a la vez con SIMD (primalidad.h), criba de
+//              Eratóstenes segmentada (criba.h), que permite límites de 10^10 o más, y
+//              Miller-Rabin con rueda (miller_rabin.h) para ventanas [inicio, limite)
+//              muy por encima de 2^32. Con --cache ARCHIVO la suma se responde desde una
+//              tabla de primos en disco (cache_primos.h) que se reutiliza entre corridas.
+//              To compile: g++ -std=c++17 -O2 sum_primos.cpp -lpthread -o app
+//              y después  ./app [--motor division|simd|criba|miller] [--inicio N] [--limite N]
+//                               [--hilos N] [--bloque N] [--cache ARCHIVO]
+//                               [--warmup N] [--repeticiones N] [--formato texto|json|csv]
 // ===========================================================================================
 
 #include <iostream>     //Entrada y salida de datos
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <atomic>
+#include <thread>       //Para saber cuántos núcleos hay
 #include <pthread.h>    //Para trabajar con hilos en c++
-#include "utils.h"      //Para la función para contabilizar el tiempo
+#include "../comun/perfilador.h"   //Cronómetros, repeticiones y estadísticas para medir los tiempos
+#include "criba.h"      //Criba de Eratóstenes segmentada
+#include "primalidad.h" //Pruebas de primalidad por división, escalar y SIMD
+#include "miller_rabin.h" //Miller-Rabin de 64 bits con rueda módulo 210
+#include "cache_primos.h" //Tabla de primos persistente
 
 using namespace std;
 
-//Guarda el inicio, fin y el resultado de la suma del rango de números primos
-struct ThreadData {
-    int start;
-    int end;
-    long long result;
+//Motores disponibles para calcular la suma
+enum Motor { DIVISION, SIMD, CRIBA, MILLER_RABIN };
+
+/*
+Trabajo compartido por todos los hilos: el rango [inicio, limite) se parte en muchos bloques pequeños y
+cada hilo toma el siguiente bloque libre con un contador atómico. Con la división por tentativa los
+números grandes cuestan más que los pequeños, así que repartir rangos fijos dejaba al último hilo
+con casi todo el trabajo; con bloques pequeños los hilos que terminan antes siguen tomando trabajo.
+*/
+struct Trabajo {
+    uint64_t inicio;
+    uint64_t limite;
+    uint64_t bloque;
+    atomic<uint64_t> siguiente;
+    Motor motor;
+    VueltasPorHilo* vueltas;    //Tiempo que tardó cada hilo en cada bloque
+};
+
+//Guarda el resultado de la suma de cada hilo. Cada uno ocupa su propia línea de caché para que
+//los hilos no se estorben al escribir (false sharing) aunque estén juntos en el arreglo
+struct alignas(64) ThreadData {
+    Trabajo* trabajo;
+    int indice;
+    uint128 result;
+    uint64_t bloques;
 };
 
 /*
-Recibe un entero, empieza el ciclo en 2 (porque el 1 naturalmente es primo). Mientras el cuadrado del número sea menor 
-o igual a n, el ciclo aumenta 1 y se checa si n es divisible entre j (residuo 0), si esto es correcto, no es primo (false) 
-ya que un número primo nada más es divisible entre sí mismo y entre el 1.
+Suma de los primos de un bloque [start, end) con el motor indicado. criba, candidatos y primos son
+del hilo que llama y se reutilizan de un bloque a otro.
 */
-bool es_primo(int n) {
-    for (int j = 2; j * j <= n; j++) {
-        if (n % j == 0) {
-            return false;
+uint128 suma_bloque(Motor motor, uint64_t start, uint64_t end, CribaSegmentada* criba, vector<uint32_t>& candidatos, vector<uint8_t>& primos) {
+    uint128 suma = 0;
+    if (criba) {
+        return criba->suma(start, end);
+    }
+    if (motor == MILLER_RABIN) {
+        return suma_primos_miller_rabin(start, end);
+    }
+    if (motor == SIMD) {
+        candidatos.clear();
+        if (start <= 2 && end > 2) candidatos.push_back(2);
+        for (uint64_t i = max<uint64_t>(start, 3) | 1; i < end; i += 2) {
+            candidatos.push_back((uint32_t) i);
+        }
+        primos.resize(candidatos.size());
+        es_primo_batch(candidatos.data(), candidatos.size(), primos.data());
+        for (size_t k = 0; k < candidatos.size(); k++) {
+            if (primos[k]) suma += candidatos[k];
+        }
+        return suma;
+    }
+    for (uint64_t i = max<uint64_t>(start, 2); i < end; i++) {
+        if (es_primo(i)) {
+            suma += i;
         }
     }
-    return true;
+    return suma;
 }
 
 /*
 Calcular la suma de los números primos en el rango especificado. Llama al puntero ThreadData para recibir los rangos a analizar, y 
 después, suma para guardar la suma de los números primos. Después, se hace un ciclo para recorrer del inicio del rango al final, 
-donde cada número del rango se checa si es primo con la función de es_primo que anteriormente declaramos, si es primo, se suma con 
+donde cada número del rango se checa si es primo con la función de es_primo (primalidad.h), si es primo, se suma con 
 el número anterior que es primo. Al final, a suma se le da el valor de resultado de la estructura, para poder llamarla en otras 
 partes del programa.
 */
 void* suma_primos(void* args) {
     ThreadData* data = (ThreadData*)args;
-    long long suma = 0;
+    Trabajo* trabajo = data->trabajo;
+    uint128 suma = 0;
+    uint64_t bloques = 0;
 
-    for (int i = data->start; i < data->end; i++) {
-        if (es_primo(i)) {
-            suma += i;
-        }
+    //Con la criba, los primos base se calculan una vez por hilo y se reutilizan en cada bloque
+    CribaSegmentada* criba = trabajo->motor == CRIBA ? new CribaSegmentada(trabajo->limite) : nullptr;
+    //Con SIMD, los impares del bloque se juntan en un arreglo y se prueban por lotes
+    vector<uint32_t> candidatos;
+    vector<uint8_t> primos;
+
+    while (true) {
+        uint64_t indice = trabajo->siguiente.fetch_add(1, memory_order_relaxed);
+        //Se compara el índice antes de multiplicar para no desbordar con límites cerca de 2^64
+        if (indice >= (trabajo->limite - trabajo->inicio + trabajo->bloque - 1) / trabajo->bloque) break;
+        uint64_t start = trabajo->inicio + indice * trabajo->bloque;
+        uint64_t end = start + min(trabajo->bloque, trabajo->limite - start);
+        bloques++;
+        Cronometro vuelta;
+        suma += suma_bloque(trabajo->motor, start, end, criba, candidatos, primos);
+        trabajo->vueltas->registrar(data->indice, vuelta.milisegundos());
     }
 
+    delete criba;
     data->result = suma;
+    data->bloques = bloques;
     return nullptr;
 }
 
 /*
 Cálculo de la suma de números primos menor al límite dado, de manera secuencial, es decir, como habitualmente lo hacemos 
-(sin hilos). donde se comienza desde el dos hasta que el número sea menor al límite y se aumenta 1 cada ciclo. Mandamos a 
-llamar la función es_primo para checar si es primo o no, si es falso, se rompe el ciclo, pero si es verdad, se suma este número 
-a la suma de primos.
+(sin hilos). donde se comienza desde el inicio (o desde el dos) hasta que el número sea menor al límite y se aumenta 1 cada ciclo.
+Mandamos a llamar la función es_primo para checar si es primo o no, si es falso, se rompe el ciclo, pero si es verdad, se suma
+este número a la suma de primos.
 */
-long long suma_primos_secuencial(int n) {
-    long long suma = 0;
-    bool es_primo;
-
-    for (int i = 2; i < n; i++) {
-        es_primo = true;
-        for (int j = 2; j * j <= i; j++) {
-            if (i % j == 0) {
-                es_primo = false;
-                break;
-            }
-        }
+uint128 suma_primos_secuencial(uint64_t inicio, uint64_t n) {
+    uint128 suma = 0;
 
-        if (es_primo) {
+    for (uint64_t i = max<uint64_t>(inicio, 2); i < n; i++) {
+        if (es_primo(i)) {
             suma += i;
         }
     }
@@ -83,50 +147,188 @@ long long suma_primos_secuencial(int n) {
     return suma;
 }
 
-int main() {
-    //Primos menores a 5 millones
-    const int limite = 5000000;
-    //Número de hilos 
-    const int num_threads = 4;  
-
-    //Almacena los hilos de trabajo
-    pthread_t threads[num_threads]; 
-    //Almacenar los rangos de cada hilo
-    ThreadData thread_data[num_threads]; 
+/*
+Versión secuencial del motor SIMD: recorre los mismos bloques que los hilos, uno tras otro, probando
+los candidatos de cada uno con es_primo_batch. Así el speedup del motor simd mide solo lo que ganan
+los hilos, no lo que gana SIMD sobre la división escalar.
+*/
+uint128 suma_primos_simd_secuencial(uint64_t inicio, uint64_t n, uint64_t bloque) {
+    uint128 suma = 0;
+    vector<uint32_t> candidatos;
+    vector<uint8_t> primos;
+    for (uint64_t start = inicio; start < n; start += min(bloque, n - start)) {
+        suma += suma_bloque(SIMD, start, start + min(bloque, n - start), nullptr, candidatos, primos);
+    }
+    return suma;
+}
 
-    //Es la cantidad de "trabajo" que va a tener cada hilo
-    int segmento = limite / num_threads;   
+int main(int argc, char* argv[]) {
+    //Primos menores a 5 millones (o los del rango [--inicio, --limite) que se indique)
+    uint64_t inicio = 0;
+    uint64_t limite = 5000000;
+    //Motor de cálculo: división por tentativa (por omisión), división SIMD, criba segmentada o Miller-Rabin
+    Motor motor = DIVISION;
+    //Número de hilos (por omisión los núcleos disponibles) y tamaño de los bloques a repartir
+    int num_threads = thread::hardware_concurrency();
+    uint64_t bloque = 0;
+    //Archivo de la caché de primos; si está vacío se calcula todo como siempre
+    string rutaCache;
+    //Corridas sin medir, corridas medidas (se reporta la mediana) y formato del reporte
+    int warmup = 0;
+    int repeticiones = 1;
+    FormatoReporte formato = TEXTO;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--limite" && i + 1 < argc) {
+            limite = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--inicio" && i + 1 < argc) {
+            inicio = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--motor" && i + 1 < argc) {
+            string nombre = argv[++i];
+            if (nombre == "division") {
+                motor = DIVISION;
+            } else if (nombre == "simd") {
+                motor = SIMD;
+            } else if (nombre == "criba") {
+                motor = CRIBA;
+            } else if (nombre == "miller") {
+                motor = MILLER_RABIN;
+            } else {
+                cerr << "Motor desconocido: " << nombre << endl;
+                return 1;
+            }
+        } else if (arg == "--hilos" && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (arg == "--bloque" && i + 1 < argc) {
+            bloque = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--cache" && i + 1 < argc) {
+            rutaCache = argv[++i];
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            warmup = max(0, atoi(argv[++i]));
+        } else if (arg == "--repeticiones" && i + 1 < argc) {
+            repeticiones = max(1, atoi(argv[++i]));
+        } else if (arg == "--formato" && i + 1 < argc) {
+            if (!leerFormato(argv[++i], formato)) {
+                cerr << "Formato desconocido: " << argv[i] << endl;
+                return 1;
+            }
+        }
+    }
+    if (num_threads <= 0) num_threads = 4;
+    if (inicio > limite) inicio = limite;
 
-    //Comienza el temporizador (obtenido de utils.h) para cronometrar el tiempo de ejecución de ambas implementaciones
-    start_timer(); 
+    //Con caché no se recalcula nada: solo se criba la parte que le falte al archivo y se consulta
+    if (!rutaCache.empty()) {
+        CachePrimos cache;
+        uint64_t reutilizados, generados;
+        Cronometro cronometro;
+        if (!cache.preparar(rutaCache, limite, reutilizados, generados)) {
+            return 1;
+        }
+        double tiempo_preparacion = cronometro.milisegundos();
+        cronometro.reiniciar();
+        uint128 resultado;
+        if (!cache.suma(inicio, limite, resultado)) {
+            cerr << "La cache " << rutaCache << " tiene un bloque danado; se regenera" << endl;
+            cache.invalidar();
+            if (!cache.preparar(rutaCache, limite, reutilizados, generados) || !cache.suma(inicio, limite, resultado)) {
+                return 1;
+            }
+        }
+        double tiempo_consulta = cronometro.milisegundos();
 
-    // Divide el rango en segmentos y crea hilos para calcular la suma de primos en cada segmento
-    for (int i = 0; i < num_threads; i++) {
-        thread_data[i].start = i * segmento + (i == 0 ? 2 : 1);
-        thread_data[i].end = (i + 1) * segmento + 1;
-        pthread_create(&threads[i], nullptr, suma_primos, &thread_data[i]);
+        cout << "Cache: " << rutaCache << " (cubre [0, " << cache.cubierto() << "), " << reutilizados
+             << " bloques reutilizados, " << generados << " generados en " << tiempo_preparacion << "ms)" << endl;
+        cout << "Resultado de la cache, rango: [" << inicio << ", " << limite << "): " << a_texto(resultado) << endl;
+        cout << "Tiempo de la consulta: " << tiempo_consulta << "ms" << endl;
+        return 0;
     }
-
-    // Espera a que todos los hilos terminen y suma los resultados
-    long long resultado = 0;
-    for (int i = 0; i < num_threads; i++) {
-        pthread_join(threads[i], nullptr);
-        resultado += thread_data[i].result;
+    //es_primo_batch trabaja con candidatos de 32 bits
+    if (motor == SIMD && limite > (1ULL << 32)) {
+        cerr << "El motor simd solo acepta limites hasta 2^32" << endl;
+        return 1;
     }
+    //Tamaño de los bloques: la criba trabaja bien con varios segmentos por bloque, la división
+    //por tentativa con bloques más pequeños para que el reparto sea más parejo
+    if (bloque == 0) bloque = motor == CRIBA ? 16 * 8 * BYTES_SEGMENTO : motor == MILLER_RABIN ? 210 * 256 : 16384;
 
-    //Detiene el tiempo para la ejecución en paralelo
-    double tiempo_paralelo = stop_timer();
+    Reporte reporte("sum_primos");
+    const char* nombres[] = {"division por tentativa", "division SIMD", "criba segmentada", "Miller-Rabin con rueda"};
+    reporte.dato("motor", nombres[motor]);
+    reporte.dato("inicio", to_string(inicio));
+    reporte.dato("limite", to_string(limite));
+    reporte.dato("hilos", num_threads);
+    reporte.dato("bloque", bloque);
+
+    //Cada corrida paralela crea sus hilos; cada uno va tomando bloques del rango hasta que no quede
+    //ninguno y registra cuánto tardó en cada bloque. Las vueltas empiezan vacías en cada corrida: al
+    //final vueltas tiene las de la última (como thread_data) y vueltas_bloque las de las medidas
+    vector<ThreadData> thread_data(num_threads);
+    VueltasPorHilo vueltas(num_threads);
+    vector<double> vueltas_bloque;
+    uint128 resultado = 0;
+    int corrida = 0;
+    vector<double> tiempos_paralelo = repetir(warmup, repeticiones, [&] {
+        vueltas = VueltasPorHilo(num_threads);
+        vector<pthread_t> threads(num_threads);
+        Trabajo trabajo{inicio, limite, bloque, {0}, motor, &vueltas};
+        for (int i = 0; i < num_threads; i++) {
+            thread_data[i].trabajo = &trabajo;
+            thread_data[i].indice = i;
+            pthread_create(&threads[i], nullptr, suma_primos, &thread_data[i]);
+        }
+
+        // Espera a que todos los hilos terminen y suma los resultados
+        resultado = 0;
+        for (int i = 0; i < num_threads; i++) {
+            pthread_join(threads[i], nullptr);
+            resultado += thread_data[i].result;
+        }
+        if (++corrida > warmup) {
+            vector<double> estas = vueltas.todas();
+            vueltas_bloque.insert(vueltas_bloque.end(), estas.begin(), estas.end());
+        }
+    });
+    reporte.agregar("paralelo", tiempos_paralelo);
+    reporte.agregar("vuelta_bloque", vueltas_bloque);
 
     // Calcula la suma de primos de forma secuencial
-    start_timer();
-    long long resultado_secuencial = suma_primos_secuencial(limite);
-    double tiempo_secuencial = stop_timer();
+    uint128 resultado_secuencial = 0;
+    vector<double> tiempos_secuencial = repetir(warmup, repeticiones, [&] {
+        if (motor == CRIBA) {
+            resultado_secuencial = CribaSegmentada(limite).suma(inicio, limite);
+        } else if (motor == MILLER_RABIN) {
+            resultado_secuencial = suma_primos_miller_rabin(inicio, limite);
+        } else if (motor == SIMD) {
+            resultado_secuencial = suma_primos_simd_secuencial(inicio, limite, bloque);
+        } else {
+            resultado_secuencial = suma_primos_secuencial(inicio, limite);
+        }
+    });
+    reporte.agregar("secuencial", tiempos_secuencial);
+    reporte.comparar("secuencial", "paralelo");
+    reporte.dato("resultado", a_texto(resultado));
+    reporte.dato("coinciden", resultado == resultado_secuencial ? "si" : "no");
 
-    // Imprime los resultados y el tiempo en milisegundos de ejecución de ambas implementaciones
-    cout << "Resultado de la ejecucion paralela (con hilos): " << resultado << endl;
-    cout << "Tiempo de la ejecucion paralela (con hilos): " << tiempo_paralelo << "ms" << endl;
-    cout << "Resultado de la ejecucion secuencia: " << resultado_secuencial << endl;
-    cout << "Tiempo de la ejecucion secuencial: " << tiempo_secuencial << "ms" << endl;
+    if (formato != TEXTO) {
+        reporte.escribir(cout, formato);
+        return resultado == resultado_secuencial ? 0 : 1;
+    }
+
+    // Imprime los resultados y la mediana del tiempo en milisegundos de ambas implementaciones
+    cout << "Motor: " << nombres[motor] << (motor == SIMD ? string(" (") + nivel_simd() + ")" : "") << ", rango: [" << inicio << ", " << limite << ")" << endl;
+    cout << "Resultado de la ejecucion paralela (con hilos): " << a_texto(resultado) << endl;
+    cout << "Tiempo de la ejecucion paralela (con " << num_threads << " hilos): " << reporte.estadisticas("paralelo").mediana << "ms" << endl;
+    //El detalle por hilo es de la última corrida
+    for (int i = 0; i < num_threads; i++) {
+        cout << "  Hilo " << i << ": " << thread_data[i].bloques << " bloques de " << bloque << ", ocupado " << vueltas.total(i) << "ms" << endl;
+    }
+    cout << "Resultado de la ejecucion secuencia: " << a_texto(resultado_secuencial) << endl;
+    cout << "Tiempo de la ejecucion secuencial: " << reporte.estadisticas("secuencial").mediana << "ms" << endl;
+    cout << "Speedup: " << reporte.speedup("secuencial", "paralelo") << endl;
+    if (repeticiones > 1) {
+        cout << "(medianas de " << repeticiones << " repeticiones despues de " << warmup << " de calentamiento)" << endl;
+    }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -4,12 +4,43 @@
 //         Uri Jared Gopar Morales  A01709413
 // Description: Este archivo contiene el código para obtener los autos que cruzan un puente
 //              los cuales deben de pasar 3 a la vez XD
-//              To compile: g++ -std=c++11 cruzandoUnPuente.cpp -o app   y después  ./app
+//              Hay tres motores con las mismas reglas (puente.h): hilos, el original, con un
+//              hilo por coche que se duerme mientras cruza; pool, con unos cuantos hilos que
+//              mueven a todos los coches como máquinas de estados (motor_pool.h); y eventos,
+//              sin hilos, con un reloj virtual que salta de evento en evento (motor_eventos.h),
+//              que simula un millón de cruces en menos de un segundo y con la misma semilla
+//              da siempre el mismo resultado. Los coches (dirección, llegada y duración del
+//              cruce) salen de --semilla y de --llegadas. En hilos y pool un segundo del
+//              original dura --escala microsegundos.
+//              --politica decide cuándo pasa la otra dirección (codiciosa, lotes, turnos o
+//              adaptativa, o todas para compararlas con los mismos coches); en el motor hilos
+//              cada coche tiene su propia variable de condición y solo se despierta cuando
+//              le toca, y --politica original usa el monitor de antes, que despierta a todos
+//              con pthread_cond_broadcast. Cada corrida reporta los coches por segundo, la
+//              espera (mediana, p99 y máximo) de cada dirección, la utilización del puente,
+//              los despertares y los cambios de contexto (metricas_puente.h).
+//              To compile: g++ -std=c++17 -O2 cruzandoUnPuente.cpp -lpthread -o app   y después  ./app
+//                          [--motor hilos|pool|eventos] [--coches N] [--semilla S]
+//                          [--politica original|codiciosa|lotes|turnos|adaptativa|todas]
+//                          [--lote K] [--turno SEGUNDOS] [--llegadas juntos|poisson|rafagas]
+//                          [--intervalo SEGUNDOS] [--rafaga N] [--sesgo P] [--hilos N]
+//                          [--escala MICROSEGUNDOS] [--traza] [--repeticiones N]
+//                          [--formato texto|json|csv]
 // =================================================================
 #include <stdio.h>
 #include <pthread.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <sys/resource.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../comun/perfilador.h"
+#include "puente.h"
+#include "motor_eventos.h"
+#include "motor_pool.h"
+#include "metricas_puente.h"
 
 using namespace std;
 
@@ -25,24 +56,54 @@ pthread_mutex_t puente = PTHREAD_MUTEX_INITIALIZER;
 pthread_cond_t norte = PTHREAD_COND_INITIALIZER;
 pthread_cond_t sur = PTHREAD_COND_INITIALIZER;
 
+//Microsegundos que dura un segundo del original y si se imprime cada cruce
+double escala = 1000000;
+bool traza = true;
+
+//Cada coche del motor hilos con su propia variable de condición: salio despierta justo a los que
+//entran y a nadie más. Con control en nullptr se usa el monitor original
+struct CocheHilo {
+    Vehiculo* coche;
+    uint32_t id;
+    pthread_cond_t turno;
+    bool admitido;
+};
+ControlPuente* control = nullptr;
+vector<CocheHilo> cochesHilo;
+vector<uint32_t> admitidos;
+Cronometro reloj;
+//Veces que un hilo salió de pthread_cond_wait, y de esas cuántas tuvo que volver a esperar (protegidos por puente)
+uint64_t despertares = 0;
+uint64_t despertaresInutiles = 0;
+
+double segundos() {
+    return reloj.microsegundos() / escala;
+}
+
 // Funciones
 void enpuente(int direction) {
     pthread_mutex_lock(&puente);
     if (direction == 0) { // Norte a Sur
         while (south > 0 ||  north== vehiculos) {
             pthread_cond_wait(&norte, &puente);
+            despertares++;
+            if (south > 0 || north == vehiculos) despertaresInutiles++;
         }
         north++;
     } else { // Sur a Norte
         while (north > 0 || south == vehiculos) {
             pthread_cond_wait(&sur, &puente);
+            despertares++;
+            if (north > 0 || south == vehiculos) despertaresInutiles++;
         }
         south++;
-        
+
     }
     pthread_mutex_unlock(&puente);
 }
 
+//Si todavía quedan coches de la misma dirección se despierta a uno de los suyos para el lugar que
+//se libera; si no, ese coche dormía hasta que el otro lado se vaciara (o para siempre si no venía nadie)
 void salio(int direction) {
     pthread_mutex_lock(&puente);
     if (direction == 0) { // Norte a Sur
@@ -50,43 +111,302 @@ void salio(int direction) {
         if (north == 0) {
             pthread_cond_broadcast(&sur);
         }
+        pthread_cond_signal(&norte);
     } else { // Sur a Norte
         south--;
         if (south == 0) {
             pthread_cond_broadcast(&norte);
         }
+        pthread_cond_signal(&sur);
     }
     cochesfinales ++;
     pthread_mutex_unlock(&puente);
 }
 
-void cruce(int direction) {
-    printf("Grupo de 3 coches que pasan por el puente: %d\n", numcoches - cochesfinales);
-    printf("Los carros van de: %s \n", direction == 0 ? "N a S" : "S a N");
-    sleep(rand() % 3 + 1);
+//Si el control no lo deja entrar, el coche duerme en su propia variable hasta que salioConAviso lo admita
+void enpuenteConAviso(CocheHilo& c) {
+    pthread_mutex_lock(&puente);
+    if (!control->llegar(c.id, c.coche->direccion, segundos())) {
+        while (!c.admitido) {
+            pthread_cond_wait(&c.turno, &puente);
+            despertares++;
+            if (!c.admitido) despertaresInutiles++;
+        }
+    }
+    c.coche->entrada = segundos();
+    pthread_mutex_unlock(&puente);
+}
+
+//Despierta solo a los coches que el control deja entrar en lugar del que sale
+void salioConAviso(CocheHilo& c) {
+    pthread_mutex_lock(&puente);
+    c.coche->salida = segundos();
+    admitidos.clear();
+    control->salir(c.coche->direccion, c.coche->salida, admitidos);
+    for (uint32_t id : admitidos) {
+        cochesHilo[id].admitido = true;
+        pthread_cond_signal(&cochesHilo[id].turno);
+    }
+    cochesfinales ++;
+    pthread_mutex_unlock(&puente);
+}
+
+void cruce(const Vehiculo* coche) {
+    if (traza) {
+        printf("Grupo de 3 coches que pasan por el puente: %d\n", numcoches - cochesfinales);
+        printf("Los carros van de: %s \n", coche->direccion == 0 ? "N a S" : "S a N");
+    }
+    usleep((useconds_t) (coche->duracion * escala));
 }
 
 void *OneVehicle(void *arg) {
-    int direction = *((int *)arg);
-    enpuente(direction);
-    cruce(direction);
-    salio(direction);
+    CocheHilo* c = (CocheHilo*) arg;
+    Vehiculo* coche = c->coche;
+    usleep((useconds_t) (coche->llegada * escala));
+    if (control) {
+        enpuenteConAviso(*c);
+        cruce(coche);
+        salioConAviso(*c);
+    } else {
+        enpuente(coche->direccion);
+        coche->entrada = segundos();
+        cruce(coche);
+        coche->salida = segundos();
+        salio(coche->direccion);
+    }
     return NULL;
 }
 
-int main() {
-    int numcoches = 20;
-    pthread_t threads[numcoches];
-    int directions[numcoches];
-
-    for (int i = 0; i < numcoches; i++) {
-        directions[i] = rand() % 2;
-        pthread_create(&threads[i], NULL, OneVehicle, &directions[i]);
+//Motor original: un hilo por coche. Sin politica usa el monitor original. Regresa false si no se pudieron crear todos los hilos
+bool simularHilos(vector<Vehiculo>& coches, const PoliticaPuente* politica, ResultadoPuente& resultado) {
+    north = south = cochesfinales = 0;
+    numcoches = coches.size();
+    despertares = despertaresInutiles = 0;
+    ControlPuente controlHilos(vehiculos, politica ? *politica : PoliticaPuente());
+    control = politica ? &controlHilos : nullptr;
+    cochesHilo.assign(coches.size(), CocheHilo());
+    for (size_t i = 0; i < coches.size(); i++) {
+        cochesHilo[i].coche = &coches[i];
+        cochesHilo[i].id = i;
+        cochesHilo[i].admitido = false;
+        pthread_cond_init(&cochesHilo[i].turno, NULL);
     }
 
-    for (int i = 0; i < numcoches; i++) {
+    reloj.reiniciar();
+    vector<pthread_t> threads(coches.size());
+    size_t creados = 0;
+    while (creados < coches.size() && pthread_create(&threads[creados], NULL, OneVehicle, &cochesHilo[creados]) == 0) {
+        creados++;
+    }
+    for (size_t i = 0; i < creados; i++) {
         pthread_join(threads[i], NULL);
     }
+    for (size_t i = 0; i < creados; i++) {
+        resultado.cruces[coches[i].direccion]++;
+        resultado.tiempoFinal = max(resultado.tiempoFinal, coches[i].salida);
+    }
+    for (CocheHilo& c : cochesHilo) pthread_cond_destroy(&c.turno);
+    resultado.eventos = 2 * creados;
+    resultado.despertares = despertares;
+    resultado.despertaresInutiles = despertaresInutiles;
+    resultado.avisos = controlHilos.avisos;
+    resultado.turnos = controlHilos.turnos;
+    control = nullptr;
+    return creados == coches.size();
+}
+
+//Cambios de contexto de todo el proceso (todos sus hilos): voluntarios (esperar un candado o dormir) e involuntarios
+void cambiosDeContexto(long& voluntarios, long& involuntarios) {
+    rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    voluntarios = uso.ru_nvcsw;
+    involuntarios = uso.ru_nivcsw;
+}
+
+//Lo que se mide de una política: sus resultados y métricas de la última repetición y los ms de todas
+struct Corrida {
+    string politica;
+    ResultadoPuente resultado;
+    MetricasPuente metricas;
+    long voluntarios = 0, involuntarios = 0;
+    vector<double> tiempos;
+};
+
+int main(int argc, char* argv[]) {
+    string motor = "hilos";
+    size_t coches = 20;
+    uint64_t semilla = 1;
+    Llegadas llegadas;
+    bool hayLlegadas = false;
+    string politicaPedida = "codiciosa";
+    PoliticaPuente politica;
+    int hilos = thread::hardware_concurrency();
+    int repeticiones = 1;
+    FormatoReporte formato = TEXTO;
+    bool conTraza = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--motor" && i + 1 < argc) {
+            motor = argv[++i];
+        } else if (arg == "--coches" && i + 1 < argc) {
+            coches = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--semilla" && i + 1 < argc) {
+            semilla = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--politica" && i + 1 < argc) {
+            politicaPedida = argv[++i];
+        } else if (arg == "--lote" && i + 1 < argc) {
+            politica.lote = max(1, atoi(argv[++i]));
+        } else if (arg == "--turno" && i + 1 < argc) {
+            politica.turno = max(0.0, atof(argv[++i]));
+        } else if (arg == "--llegadas" && i + 1 < argc) {
+            string tipo = argv[++i];
+            llegadas.tipo = tipo == "poisson" ? POISSON : tipo == "rafagas" ? RAFAGAS : JUNTOS;
+            hayLlegadas = true;
+        } else if (arg == "--intervalo" && i + 1 < argc) {
+            llegadas.intervalo = max(0.0, atof(argv[++i]));
+            //Sin --llegadas, un intervalo quiere decir llegadas de Poisson
+            if (!hayLlegadas) llegadas.tipo = llegadas.intervalo > 0 ? POISSON : JUNTOS;
+        } else if (arg == "--rafaga" && i + 1 < argc) {
+            llegadas.rafaga = max(1, atoi(argv[++i]));
+        } else if (arg == "--sesgo" && i + 1 < argc) {
+            llegadas.sesgo = min(1.0, max(0.0, atof(argv[++i])));
+        } else if (arg == "--hilos" && i + 1 < argc) {
+            hilos = atoi(argv[++i]);
+        } else if (arg == "--escala" && i + 1 < argc) {
+            escala = max(1e-3, atof(argv[++i]));
+        } else if (arg == "--traza") {
+            conTraza = true;
+        } else if (arg == "--repeticiones" && i + 1 < argc) {
+            repeticiones = max(1, atoi(argv[++i]));
+        } else if (arg == "--formato" && i + 1 < argc) {
+            if (!leerFormato(argv[++i], formato)) {
+                cerr << "Formato desconocido: " << argv[i] << endl;
+                return 1;
+            }
+        }
+    }
+    if (motor != "hilos" && motor != "pool" && motor != "eventos") {
+        cerr << "Motor desconocido: " << motor << endl;
+        return 1;
+    }
+    if (hilos <= 0) hilos = 4;
+    //El motor original imprime cada cruce como siempre; los otros solo con --traza
+    traza = (motor == "hilos" || conTraza) && formato == TEXTO;
+
+    //Políticas a correr: una sola, o todas con los mismos coches (la original solo existe con hilos)
+    const string nombres[] = {"codiciosa", "lotes", "turnos", "adaptativa"};
+    vector<string> politicas;
+    if (politicaPedida == "todas") {
+        if (motor == "hilos") politicas.push_back("original");
+        politicas.insert(politicas.end(), begin(nombres), end(nombres));
+    } else {
+        politicas.push_back(politicaPedida);
+    }
+    for (const string& nombre : politicas) {
+        if (nombre == "original" ? motor != "hilos" : find(begin(nombres), end(nombres), nombre) == end(nombres)) {
+            cerr << "Politica desconocida para el motor " << motor << ": " << nombre << endl;
+            return 1;
+        }
+    }
+
+    vector<Corrida> corridas;
+    for (const string& nombre : politicas) {
+        Corrida corrida;
+        corrida.politica = nombre;
+        PoliticaPuente p = politica;
+        const string* indice = find(begin(nombres), end(nombres), nombre);
+        p.tipo = indice == end(nombres) ? CODICIOSA : (TipoPolitica) (indice - begin(nombres));
+        for (int r = 0; r < repeticiones; r++) {
+            vector<Vehiculo> lista = generarVehiculos(coches, semilla, llegadas);
+            ResultadoPuente resultado;
+            bool completo = true;
+            long voluntarios, involuntarios, voluntariosFin, involuntariosFin;
+            cambiosDeContexto(voluntarios, involuntarios);
+            Cronometro cronometro;
+            if (motor == "eventos") {
+                resultado = simularEventos(lista, vehiculos, p, traza);
+            } else if (motor == "pool") {
+                MotorPool pool(lista, vehiculos, p, hilos, escala, traza);
+                completo = pool.correr(resultado);
+            } else {
+                completo = simularHilos(lista, nombre == "original" ? nullptr : &p, resultado);
+            }
+            corrida.tiempos.push_back(cronometro.milisegundos());
+            cambiosDeContexto(voluntariosFin, involuntariosFin);
+            if (!completo) {
+                cerr << "No se pudieron crear todos los hilos; pruebe con --motor pool o --motor eventos" << endl;
+                return 1;
+            }
+            corrida.resultado = resultado;
+            corrida.metricas = medirPuente(lista, vehiculos);
+            corrida.voluntarios = voluntariosFin - voluntarios;
+            corrida.involuntarios = involuntariosFin - involuntarios;
+        }
+        corridas.push_back(corrida);
+    }
+
+    //Con varias políticas cada dato lleva el nombre de la suya al principio
+    Reporte reporte("cruzandoUnPuente");
+    reporte.dato("motor", motor);
+    reporte.dato("coches", coches);
+    reporte.dato("semilla", semilla);
+    const char* tiposLlegadas[] = {"juntos", "poisson", "rafagas"};
+    reporte.dato("llegadas", tiposLlegadas[llegadas.tipo]);
+    reporte.dato("sesgo", llegadas.sesgo);
+    for (const Corrida& c : corridas) {
+        string prefijo = corridas.size() > 1 ? c.politica + "_" : "";
+        const ResultadoPuente& r = c.resultado;
+        const MetricasPuente& m = c.metricas;
+        if (corridas.size() == 1) reporte.dato("politica", c.politica);
+        reporte.dato(prefijo + "cruces_norte_sur", r.cruces[NORTE_SUR]);
+        reporte.dato(prefijo + "cruces_sur_norte", r.cruces[SUR_NORTE]);
+        reporte.dato(prefijo + "tiempo_final_s", r.tiempoFinal);
+        reporte.dato(prefijo + "eventos", r.eventos);
+        const char* direcciones[] = {"norte_sur", "sur_norte"};
+        for (int d = 0; d < 2; d++) {
+            string sufijo = string("_") + direcciones[d];
+            reporte.dato(prefijo + "por_segundo" + sufijo, m.porSegundo[d]);
+            reporte.dato(prefijo + "espera_p50_s" + sufijo, m.espera[d].mediana);
+            reporte.dato(prefijo + "espera_p99_s" + sufijo, m.espera[d].p99);
+            reporte.dato(prefijo + "espera_max_s" + sufijo, m.espera[d].maximo);
+        }
+        reporte.dato(prefijo + "utilizacion", m.utilizacion);
+        reporte.dato(prefijo + "ocupacion", m.ocupacion);
+        reporte.dato(prefijo + "turnos", r.turnos);
+        reporte.dato(prefijo + "avisos", r.avisos);
+        if (motor != "eventos") {       // El motor de eventos no tiene hilos que esperen
+            reporte.dato(prefijo + "despertares", r.despertares);
+            reporte.dato(prefijo + "despertares_inutiles", r.despertaresInutiles);
+        }
+        reporte.dato(prefijo + "cambios_contexto_voluntarios", c.voluntarios);
+        reporte.dato(prefijo + "cambios_contexto_involuntarios", c.involuntarios);
+        reporte.agregar("simulacion_" + c.politica, c.tiempos);
+    }
+    if (formato != TEXTO) {
+        reporte.escribir(cout, formato);
+        return 0;
+    }
+
+    const string tiempo = motor == "eventos" ? "virtuales" : "escalados";
+    for (const Corrida& c : corridas) {
+        const ResultadoPuente& r = c.resultado;
+        const MetricasPuente& m = c.metricas;
+        cout << "\nPolitica " << c.politica << ": cruzaron " << r.cruces[NORTE_SUR] + r.cruces[SUR_NORTE] << " coches ("
+             << r.cruces[NORTE_SUR] << " de N a S, " << r.cruces[SUR_NORTE] << " de S a N) en " << r.tiempoFinal
+             << " segundos " << tiempo << ", " << r.turnos << " turnos\n";
+        const char* direcciones[] = {"N a S", "S a N"};
+        for (int d = 0; d < 2; d++) {
+            cout << "  " << direcciones[d] << ": " << m.porSegundo[d] << " coches/s, espera p50 " << m.espera[d].mediana
+                 << " s, p99 " << m.espera[d].p99 << " s, max " << m.espera[d].maximo << " s\n";
+        }
+        cout << "  Puente ocupado " << m.utilizacion * 100 << "% del tiempo, " << m.ocupacion * 100 << "% lleno en promedio\n";
+        cout << "  Avisos " << r.avisos;
+        if (motor != "eventos") cout << ", despertares " << r.despertares << " (" << r.despertaresInutiles << " inutiles)";
+        cout << ", cambios de contexto " << c.voluntarios << " voluntarios y " << c.involuntarios << " involuntarios\n";
+        cout << "  Motor " << motor << ": " << r.eventos << " eventos en " << reporte.estadisticas("simulacion_" + c.politica).mediana << " ms";
+        if (repeticiones > 1) cout << " (mediana de " << repeticiones << " repeticiones)";
+        cout << endl;
+    }
 
     return 0;
-}
\ No newline at end of file
+}
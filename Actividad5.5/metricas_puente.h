@@ -0,0 +1,73 @@
+// ==========================================================================
+// File: metricas_puente.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene las métricas de una corrida del puente, calculadas a
+//              partir de las horas de llegada, entrada y salida que dejan los motores en
+//              cada coche, así que son las mismas para los tres motores: coches por segundo
+//              en cada dirección, la espera (mediana, p99 y máximo) de cada dirección, qué
+//              fracción del tiempo estuvo ocupado el puente y qué tan lleno iba en promedio.
+// ===========================================================================================
+
+#ifndef METRICAS_PUENTE_H
+#define METRICAS_PUENTE_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "../comun/perfilador.h"
+#include "puente.h"
+
+struct MetricasPuente {
+    double porSegundo[2] = {0, 0};      // Coches que cruzaron por segundo en cada dirección
+    Estadisticas espera[2];             // Segundos entre la llegada y la entrada al puente
+    double utilizacion = 0;             // Fracción del tiempo con al menos un coche en el puente
+    double ocupacion = 0;               // Coches en el puente en promedio entre la capacidad
+};
+
+/*
+Las esperas se ordenan por dirección para sacar sus percentiles. La utilización recorre las entradas y
+salidas en orden de tiempo llevando la cuenta de los coches en el puente; el tiempo total va desde la
+primera llegada hasta la última salida.
+*/
+inline MetricasPuente medirPuente(const std::vector<Vehiculo>& vehiculos, int capacidad) {
+    MetricasPuente m;
+    if (vehiculos.empty()) return m;
+
+    std::vector<double> esperas[2];
+    std::vector<std::pair<double, int>> cambios;      // (hora, +1 entra o -1 sale)
+    cambios.reserve(2 * vehiculos.size());
+    double inicio = vehiculos[0].llegada, fin = 0;
+    for (const Vehiculo& v : vehiculos) {
+        esperas[v.direccion].push_back(v.entrada - v.llegada);
+        cambios.push_back({v.entrada, 1});
+        cambios.push_back({v.salida, -1});
+        inicio = std::min(inicio, v.llegada);
+        fin = std::max(fin, v.salida);
+    }
+    double total = fin - inicio;
+    for (int d = 0; d < 2; d++) {
+        m.espera[d] = calcularEstadisticas(esperas[d]);
+        if (total > 0) m.porSegundo[d] = esperas[d].size() / total;
+    }
+
+    // Con la misma hora las salidas (-1) van antes que las entradas, así que el puente no parece más lleno de lo que está
+    std::sort(cambios.begin(), cambios.end());
+    double ocupado = 0, cocheSegundos = 0;
+    int enPuente = 0;
+    for (size_t i = 0; i < cambios.size(); i++) {
+        enPuente += cambios[i].second;
+        if (i + 1 < cambios.size()) {
+            double lapso = cambios[i + 1].first - cambios[i].first;
+            if (enPuente > 0) ocupado += lapso;
+            cocheSegundos += enPuente * lapso;
+        }
+    }
+    if (total > 0) {
+        m.utilizacion = ocupado / total;
+        m.ocupacion = cocheSegundos / (total * capacidad);
+    }
+    return m;
+}
+
+#endif
@@ -0,0 +1,66 @@
+// ==========================================================================
+// File: motor_eventos.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene el motor de eventos discretos del puente: en vez de
+//              dormir un hilo por coche, un reloj virtual salta de un evento al siguiente
+//              (una llegada o el fin de un cruce) en orden de tiempo. No hay hilos ni
+//              esperas reales, así que un millón de cruces toman una fracción de segundo y
+//              con la misma semilla el resultado es siempre el mismo.
+// ===========================================================================================
+
+#ifndef MOTOR_EVENTOS_H
+#define MOTOR_EVENTOS_H
+
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "puente.h"
+
+/*
+Simula el cruce de todos los vehículos, que deben venir ordenados por hora de llegada (como los da
+generarVehiculos). Las llegadas se toman del arreglo en orden y solo los fines de cruce van en la cola
+de prioridad, que nunca tiene más coches que los que caben en el puente. Si un coche sale y otro llega
+en el mismo instante, primero sale el que estaba en el puente. Con traza se imprime cada entrada.
+*/
+inline ResultadoPuente simularEventos(std::vector<Vehiculo>& vehiculos, int capacidad, const PoliticaPuente& politica, bool traza) {
+    ResultadoPuente resultado;
+    ControlPuente control(capacidad, politica);
+    std::priority_queue<Evento, std::vector<Evento>, std::greater<Evento>> salidas;
+    std::vector<uint32_t> admitidos;
+    uint64_t orden = 0;
+
+    auto entrar = [&](uint32_t id, double tiempo) {
+        Vehiculo& v = vehiculos[id];
+        v.entrada = tiempo;
+        salidas.push({tiempo + v.duracion, orden++, id});
+        if (traza) {
+            printf("%10.3f  coche %u entra al puente (%s)\n", tiempo, id, v.direccion == NORTE_SUR ? "N a S" : "S a N");
+        }
+    };
+
+    size_t siguiente = 0;
+    while (siguiente < vehiculos.size() || !salidas.empty()) {
+        resultado.eventos++;
+        if (!salidas.empty() && (siguiente == vehiculos.size() || salidas.top().tiempo <= vehiculos[siguiente].llegada)) {
+            Evento e = salidas.top();
+            salidas.pop();
+            Vehiculo& v = vehiculos[e.vehiculo];
+            v.salida = e.tiempo;
+            resultado.cruces[v.direccion]++;
+            resultado.tiempoFinal = e.tiempo;
+            admitidos.clear();
+            control.salir(v.direccion, e.tiempo, admitidos);
+            for (uint32_t id : admitidos) entrar(id, e.tiempo);
+        } else {
+            uint32_t id = siguiente++;
+            if (control.llegar(id, vehiculos[id].direccion, vehiculos[id].llegada)) entrar(id, vehiculos[id].llegada);
+        }
+    }
+    resultado.avisos = control.avisos;
+    resultado.turnos = control.turnos;
+    return resultado;
+}
+
+#endif
@@ -0,0 +1,183 @@
+// ==========================================================================
+// File: motor_pool.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene el motor del puente con un número fijo de hilos: cada
+//              coche es una máquina de estados (llega, cruza, sale) y no un hilo. Los
+//              trabajadores toman el siguiente paso listo de una cola; un coche que espera o
+//              que está cruzando no ocupa ningún hilo, solo un lugar en una cola o en el
+//              reloj de salidas. El tiempo es real pero escalado: un segundo del original
+//              dura escala microsegundos, así que se pueden simular miles de coches con
+//              unos cuantos hilos.
+// ===========================================================================================
+
+#ifndef MOTOR_POOL_H
+#define MOTOR_POOL_H
+
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <vector>
+#include <pthread.h>
+#include "../comun/perfilador.h"
+#include "puente.h"
+
+class MotorPool {
+public:
+    MotorPool(std::vector<Vehiculo>& vehiculos, int capacidad, const PoliticaPuente& politica, int hilos, double escala, bool traza)
+        : vehiculos(vehiculos), control(capacidad, politica), hilos(hilos), escala(escala), traza(traza) {
+        pthread_mutex_init(&mutex, nullptr);
+        pthread_mutex_init(&puente, nullptr);
+        pthread_condattr_t atributos;
+        pthread_condattr_init(&atributos);
+        pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC);
+        pthread_cond_init(&hayTrabajo, &atributos);
+        pthread_condattr_destroy(&atributos);
+    }
+
+    ~MotorPool() {
+        pthread_mutex_destroy(&mutex);
+        pthread_mutex_destroy(&puente);
+        pthread_cond_destroy(&hayTrabajo);
+    }
+
+    // Corre la simulación completa; regresa false si no se pudo crear algún hilo
+    bool correr(ResultadoPuente& resultado) {
+        reloj.reiniciar();
+        std::vector<pthread_t> threads(hilos);
+        int creados = 0;
+        while (creados < hilos && pthread_create(&threads[creados], nullptr, trabajador, this) == 0) creados++;
+        if (creados == 0) return false;
+        for (int i = 0; i < creados; i++) pthread_join(threads[i], nullptr);
+        resultado = totales;
+        resultado.avisos = control.avisos;
+        resultado.turnos = control.turnos;
+        return creados == hilos;
+    }
+
+private:
+    // Un paso de la máquina de estados de un coche: llegar al puente o terminar de cruzarlo
+    struct Tarea {
+        uint32_t vehiculo;
+        bool sale;
+    };
+
+    static void* trabajador(void* arg) {
+        ((MotorPool*) arg)->trabajar();
+        return nullptr;
+    }
+
+    /*
+    Ciclo de cada trabajador. Con mutex tomado pasa a listos las llegadas y las salidas cuya hora ya
+    llegó; si hay algo listo lo ejecuta sin el candado y si no, duerme hasta la siguiente hora
+    conocida o hasta que otro trabajador programe una salida. Cada regreso de la espera cuenta como
+    despertar, y como inútil si no encontró nada listo y tiene que volver a dormir.
+    */
+    void trabajar() {
+        std::vector<uint32_t> admitidos;
+        bool desperto = false;
+        pthread_mutex_lock(&mutex);
+        while (terminados < vehiculos.size()) {
+            double ahora = reloj.microsegundos();
+            while (siguiente < vehiculos.size() && vehiculos[siguiente].llegada * escala <= ahora) {
+                listos.push_back({(uint32_t) siguiente++, false});
+            }
+            while (!salidas.empty() && salidas.top().tiempo <= ahora) {
+                listos.push_back({salidas.top().vehiculo, true});
+                salidas.pop();
+            }
+            if (desperto && listos.empty()) totales.despertaresInutiles++;
+            desperto = false;
+            if (!listos.empty()) {
+                Tarea tarea = listos.front();
+                listos.pop_front();
+                totales.eventos++;
+                if (!listos.empty()) pthread_cond_signal(&hayTrabajo);
+                pthread_mutex_unlock(&mutex);
+                ejecutar(tarea, admitidos);
+                pthread_mutex_lock(&mutex);
+                continue;
+            }
+
+            double proximo = -1;
+            if (siguiente < vehiculos.size()) proximo = vehiculos[siguiente].llegada * escala;
+            if (!salidas.empty() && (proximo < 0 || salidas.top().tiempo < proximo)) proximo = salidas.top().tiempo;
+            if (proximo < 0) {
+                pthread_cond_wait(&hayTrabajo, &mutex);
+            } else {
+                esperarHasta(proximo - ahora);
+            }
+            totales.despertares++;
+            desperto = true;
+        }
+        pthread_cond_broadcast(&hayTrabajo);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    void ejecutar(Tarea tarea, std::vector<uint32_t>& admitidos) {
+        Vehiculo& v = vehiculos[tarea.vehiculo];
+        admitidos.clear();
+        pthread_mutex_lock(&puente);
+        double ahora = reloj.microsegundos();       // Dentro del candado: las horas quedan en el orden en que se decidieron
+        if (!tarea.sale) {
+            if (control.llegar(tarea.vehiculo, v.direccion, ahora / escala)) admitidos.push_back(tarea.vehiculo);
+        } else {
+            control.salir(v.direccion, ahora / escala, admitidos);
+        }
+        pthread_mutex_unlock(&puente);
+
+        for (uint32_t id : admitidos) cruzar(id, ahora);
+        if (tarea.sale) {
+            v.salida = ahora / escala;
+            pthread_mutex_lock(&mutex);
+            totales.cruces[v.direccion]++;
+            if (v.salida > totales.tiempoFinal) totales.tiempoFinal = v.salida;
+            if (++terminados == vehiculos.size()) pthread_cond_broadcast(&hayTrabajo);
+            pthread_mutex_unlock(&mutex);
+        }
+    }
+
+    // El coche id entra al puente en ahora y se programa su salida
+    void cruzar(uint32_t id, double ahora) {
+        Vehiculo& v = vehiculos[id];
+        v.entrada = ahora / escala;
+        if (traza) {
+            printf("%10.3f  coche %u entra al puente (%s)\n", v.entrada, id, v.direccion == NORTE_SUR ? "N a S" : "S a N");
+        }
+        pthread_mutex_lock(&mutex);
+        salidas.push({ahora + v.duracion * escala, orden++, id});
+        pthread_cond_signal(&hayTrabajo);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // Duerme (soltando mutex) a lo más microsegundos, o hasta que alguien avise
+    void esperarHasta(double microsegundos) {
+        timespec limite;
+        clock_gettime(CLOCK_MONOTONIC, &limite);
+        long long nanos = limite.tv_nsec + (long long) (microsegundos * 1000) + 1;
+        limite.tv_sec += nanos / 1000000000;
+        limite.tv_nsec = nanos % 1000000000;
+        pthread_cond_timedwait(&hayTrabajo, &mutex, &limite);
+    }
+
+    std::vector<Vehiculo>& vehiculos;
+    ControlPuente control;
+    int hilos;
+    double escala;                  // Microsegundos reales por segundo del original
+    bool traza;
+    Cronometro reloj;
+
+    pthread_mutex_t puente;         // Protege control, como el candado puente del original
+    pthread_mutex_t mutex;          // Protege todo lo de abajo
+    pthread_cond_t hayTrabajo;
+    std::deque<Tarea> listos;
+    std::priority_queue<Evento, std::vector<Evento>, std::greater<Evento>> salidas;     // En microsegundos desde el inicio
+    size_t siguiente = 0;           // Siguiente coche por llegar
+    size_t terminados = 0;
+    uint64_t orden = 0;
+    ResultadoPuente totales;
+};
+
+#endif
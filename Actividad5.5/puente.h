@@ -0,0 +1,203 @@
+// ==========================================================================
+// File: puente.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene las reglas del puente que comparten los motores de
+//              cruzandoUnPuente.cpp, separadas de los hilos: los coches que llegan (con su
+//              dirección, su hora de llegada y cuánto tardan en cruzar, generados con una
+//              semilla y con distintas formas de llegar) y el control del puente, que decide
+//              quién entra con las mismas reglas que enpuente y salio (a lo más 3 coches,
+//              todos en la misma dirección) y una política que decide cuándo le toca a la
+//              otra dirección, y forma en una cola por dirección a los que tienen que esperar.
+// ===========================================================================================
+
+#ifndef PUENTE_H
+#define PUENTE_H
+
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+// Direcciones como en el programa original: 0 es de norte a sur y 1 de sur a norte
+const int NORTE_SUR = 0;
+const int SUR_NORTE = 1;
+
+struct Vehiculo {
+    uint8_t direccion;
+    uint8_t duracion;       // Segundos que tarda en cruzar, de 1 a 3 como el sleep(rand() % 3 + 1) original
+    double llegada;         // Segundos desde el inicio de la simulación
+    double entrada = 0;     // Cuándo entró al puente y cuándo salió (los llena el motor)
+    double salida = 0;
+};
+
+enum TipoLlegadas { JUNTOS, POISSON, RAFAGAS };
+
+// Cómo llegan los coches
+struct Llegadas {
+    TipoLlegadas tipo = JUNTOS;
+    double intervalo = 1;       // Segundos entre llegadas en promedio (POISSON y RAFAGAS)
+    double sesgo = 0.5;         // Probabilidad de que un coche vaya de norte a sur
+    int rafaga = 10;            // Coches por ráfaga
+};
+
+/*
+Genera numcoches coches con la semilla dada: la misma semilla da siempre los mismos coches. JUNTOS es
+como los hilos del original, que se crean de golpe: todos llegan en el segundo 0. En POISSON el tiempo
+entre una llegada y la siguiente es exponencial con media intervalo; en RAFAGAS llegan grupos de rafaga
+coches en el mismo instante, con el mismo promedio de coches por segundo. Con un sesgo distinto de 0.5
+una dirección recibe un flujo constante y la otra apenas unos cuantos coches.
+*/
+inline std::vector<Vehiculo> generarVehiculos(size_t numcoches, uint64_t semilla, const Llegadas& llegadas) {
+    std::mt19937_64 azar(semilla);
+    double intervalo = llegadas.intervalo > 0 ? llegadas.intervalo : 1;
+    int rafaga = llegadas.rafaga > 0 ? llegadas.rafaga : 1;
+    std::exponential_distribution<double> espera(1 / intervalo), esperaRafaga(1 / (intervalo * rafaga));
+    std::uniform_real_distribution<double> moneda(0, 1);
+    std::vector<Vehiculo> vehiculos(numcoches);
+    double tiempo = 0;
+    for (size_t i = 0; i < numcoches; i++) {
+        Vehiculo& v = vehiculos[i];
+        v.direccion = moneda(azar) < llegadas.sesgo ? NORTE_SUR : SUR_NORTE;
+        v.duracion = azar() % 3 + 1;
+        if (llegadas.tipo == POISSON) tiempo += espera(azar);
+        if (llegadas.tipo == RAFAGAS && i % rafaga == 0 && i > 0) tiempo += esperaRafaga(azar);
+        v.llegada = tiempo;
+    }
+    return vehiculos;
+}
+
+enum TipoPolitica { CODICIOSA, LOTES, TURNOS, ADAPTATIVA };
+
+/*
+Cuándo deja de entrar la dirección que tiene el puente para darle paso a la otra. La codiciosa es la
+regla del original: la dirección que tiene el puente lo conserva mientras sigan llegando coches, así
+que con un flujo constante de un lado el otro nunca pasa. Las demás cierran el paso a la dirección
+actual (los que ya están terminan de cruzar) cuando del otro lado hay alguien esperando y además:
+LOTES, ya entraron lote coches en este turno; TURNOS, el turno ya duró turno segundos; ADAPTATIVA, la
+cola del otro lado es más larga que la propia y ya entró al menos un puente lleno.
+*/
+struct PoliticaPuente {
+    TipoPolitica tipo = CODICIOSA;
+    int lote = 6;
+    double turno = 6;
+};
+
+/*
+Control del puente sin hilos ni candados: quien lo use debe protegerlo. Un coche entra si no hay nadie
+en sentido contrario, hay lugar y la política no le ha cerrado el paso a su dirección; si no, se forma
+en la cola de su dirección y nadie lo despierta hasta que le toca: salir regresa los coches que entran
+en lugar del que sale, así que cada coche formado recibe un solo aviso, cuando ya es su turno. ahora
+son los segundos desde el inicio, que solo usa la política TURNOS.
+*/
+class ControlPuente {
+public:
+    explicit ControlPuente(int capacidad = 3, PoliticaPuente politica = PoliticaPuente()) : capacidad(capacidad), politica(politica) {}
+
+    // Llega el coche id: regresa true si entra en este momento, false si se formó
+    bool llegar(uint32_t id, int direccion, double ahora) {
+        if (cola[direccion].empty() && puedeEntrar(direccion, ahora)) {
+            if (dentro[direccion] == 0) iniciarTurno(ahora);
+            dentro[direccion]++;
+            enTurno++;
+            return true;
+        }
+        cola[direccion].push_back(id);
+        return false;
+    }
+
+    /*
+    Sale un coche de direccion y deja en admitidos los que entran en su lugar. Como en salio, cuando
+    sale el último de una dirección pasan los que esperan del otro lado (si no hay nadie, los de la
+    misma). A diferencia de salio, que solo despertaba al otro lado, si todavía quedan coches de la
+    misma dirección el lugar libre se le da al siguiente de la misma cola cuando la política lo deja:
+    en el original ese coche se quedaba dormido hasta que el otro lado se vaciara, y si del otro lado
+    no venía nadie, para siempre.
+    */
+    void salir(int direccion, double ahora, std::vector<uint32_t>& admitidos) {
+        dentro[direccion]--;
+        if (dentro[direccion] == 0) {
+            int siguiente = cola[1 - direccion].empty() ? direccion : 1 - direccion;
+            if (!cola[siguiente].empty()) iniciarTurno(ahora);
+            admitir(siguiente, ahora, admitidos);
+        } else {
+            admitir(direccion, ahora, admitidos);
+        }
+    }
+
+    int enPuente(int direccion) const {
+        return dentro[direccion];
+    }
+
+    size_t esperando(int direccion) const {
+        return cola[direccion].size();
+    }
+
+    uint64_t avisos = 0;            // Coches formados a los que se les dio el paso
+    uint64_t turnos = 0;            // Veces que el puente empezó un turno (con el puente vacío)
+
+private:
+    bool puedeEntrar(int direccion, double ahora) const {
+        if (dentro[1 - direccion] > 0 || dentro[direccion] >= capacidad) return false;
+        return dentro[direccion] == 0 || !cerrado(direccion, ahora);
+    }
+
+    // La política le cierra el paso a la dirección que tiene el puente
+    bool cerrado(int direccion, double ahora) const {
+        if (cola[1 - direccion].empty()) return false;
+        switch (politica.tipo) {
+            case LOTES: return enTurno >= politica.lote;
+            case TURNOS: return ahora - inicioTurno >= politica.turno;
+            case ADAPTATIVA: return cola[1 - direccion].size() > cola[direccion].size() && enTurno >= capacidad;
+            default: return false;
+        }
+    }
+
+    void iniciarTurno(double ahora) {
+        enTurno = 0;
+        inicioTurno = ahora;
+        turnos++;
+    }
+
+    // Los primeros de la cola de direccion que quepan
+    void admitir(int direccion, double ahora, std::vector<uint32_t>& admitidos) {
+        while (!cola[direccion].empty() && puedeEntrar(direccion, ahora)) {
+            admitidos.push_back(cola[direccion].front());
+            cola[direccion].pop_front();
+            dentro[direccion]++;
+            enTurno++;
+            avisos++;
+        }
+    }
+
+    int capacidad;
+    PoliticaPuente politica;
+    int dentro[2] = {0, 0};         // Los north y south del original
+    std::deque<uint32_t> cola[2];
+    int enTurno = 0;                // Coches que han entrado desde que empezó el turno
+    double inicioTurno = 0;
+};
+
+// Fin del cruce de un coche. orden desempata los eventos del mismo instante en el orden en que se crearon
+struct Evento {
+    double tiempo;
+    uint64_t orden;
+    uint32_t vehiculo;
+
+    bool operator>(const Evento& otro) const {
+        return tiempo != otro.tiempo ? tiempo > otro.tiempo : orden > otro.orden;
+    }
+};
+
+// Lo que reporta cualquiera de los motores
+struct ResultadoPuente {
+    uint64_t cruces[2] = {0, 0};    // Coches que terminaron de cruzar en cada dirección
+    double tiempoFinal = 0;         // Segundos (virtuales o escalados) hasta que salió el último
+    uint64_t eventos = 0;
+    uint64_t avisos = 0;            // Coches formados a los que se les dio el paso
+    uint64_t despertares = 0;       // Veces que un hilo salió de pthread_cond_wait (motores hilos y pool)
+    uint64_t despertaresInutiles = 0;       // ... y tuvo que volver a esperar
+    uint64_t turnos = 0;
+};
+
+#endif
@@ -0,0 +1,377 @@
+// ===========================================================================================
+// File: benchmark.cpp
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Pruebas de rendimiento del resaltador. Trabaja sobre un directorio de archivos
+//              .cs o sobre un corpus sintético (corpus.h), hace corridas de calentamiento y
+//              varias iteraciones medidas (comun/perfilador.h) para cada número de hilos, y
+//              reporta MB/s, tokens/s, latencia por archivo (p50/p99), la dispersión de las
+//              iteraciones (MAD e intervalo de confianza) y speedup en JSON.
+//              También mide con un hilo cada nivel del escáner SIMD que soporte el procesador
+//              (escalar, sse4.2, avx2) y verifica que todos generen el mismo HTML; los
+//              perfiles comentarios y strings son los que más pasan por él.
+//              Con --regex además verifica que la versión con std::regex genere el mismo HTML
+//              y mide sus tokens/s. Con --clasificador compara, sobre los identificadores del
+//              corpus, la tabla hash perfecta de clasificarIdentificador contra la búsqueda
+//              binaria y las expresiones keyword y system del original (usar --perfil
+//              identificadores para la entrada con más identificadores).
+//              To compile: g++ -std=c++17 -O2 benchmark.cpp -lpthread -o benchmark
+//              y después  ./benchmark [--perfil mixto|comentarios|strings|anidado|gigante|identificadores]
+//                         [--corpus DIR] [--bytes N] [--archivos N] [--semilla S] [--warmup N]
+//                         [--iteraciones N] [--hilos 1,2,4,8] [--regex] [--clasificador]
+// ===========================================================================================
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <pthread.h>
+#include "../comun/perfilador.h"
+#include "resaltador.h"
+#include "resaltador_regex.h"
+#include "corpus.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct Opciones {
+    string directorio = "./csharp_examples";
+    bool sintetico = false;
+    string nombrePerfil = "mixto";
+    PerfilCorpus perfil = MIXTO;
+    size_t bytes = 4 << 20;
+    size_t archivos = 200;
+    uint64_t semilla = 1;
+    int warmup = 3;
+    int iteraciones = 20;
+    vector<int> hilos;
+    bool regex = false;
+    bool clasificador = false;
+};
+
+// Estado compartido por los hilos durante una iteración
+struct Corrida {
+    const vector<string>* contenidos;
+    const vector<size_t>* orden;        // Índices de archivo, del más grande al más pequeño
+    atomic<size_t> siguiente{0};
+    int hilos;
+};
+
+// Lo que mide cada hilo
+struct Medicion {
+    Corrida* corrida;
+    size_t tokens = 0;
+    vector<double> latencias;           // us por archivo
+};
+
+void* trabajar(void* arg) {
+    Medicion* medicion = (Medicion*) arg;
+    Corrida* corrida = medicion->corrida;
+    EmisorHTML emisor;
+    size_t i;
+    while ((i = corrida->siguiente.fetch_add(1, memory_order_relaxed)) < corrida->orden->size()) {
+        const string& contenido = (*corrida->contenidos)[(*corrida->orden)[i]];
+        Cronometro cronometro;
+        emisor.reiniciar(capacidadEsperada(contenido.size()));
+        // Si hay un solo archivo y varios hilos, se reparte el archivo en fragmentos
+        if (corrida->orden->size() == 1 && corrida->hilos > 1) {
+            medicion->tokens += resaltarContenidoPorPartes(contenido, buscarCortes(contenido, corrida->hilos), emisor);
+        } else {
+            medicion->tokens += resaltarContenido(contenido, emisor);
+        }
+        medicion->latencias.push_back(cronometro.microsegundos());
+    }
+    return nullptr;
+}
+
+struct Resultado {
+    int hilos;
+    Estadisticas tiempo;            // ms por iteración
+    double mbPorSegundo;
+    double tokensPorSegundo;
+    double p50, p99;
+};
+
+Resultado medir(const vector<string>& contenidos, const vector<size_t>& orden, size_t bytes, int hilos, const Opciones& opciones) {
+    vector<double> latencias;
+    size_t tokens = 0;
+    int iteracion = 0;
+
+    vector<double> tiempos = repetir(opciones.warmup, opciones.iteraciones, [&] {
+        Corrida corrida;
+        corrida.contenidos = &contenidos;
+        corrida.orden = &orden;
+        corrida.hilos = hilos;
+        vector<Medicion> mediciones(hilos);
+        vector<pthread_t> threads(hilos);
+        for (int h = 0; h < hilos; h++) {
+            mediciones[h].corrida = &corrida;
+            pthread_create(&threads[h], NULL, trabajar, &mediciones[h]);
+        }
+        for (int h = 0; h < hilos; h++) {
+            pthread_join(threads[h], NULL);
+        }
+
+        if (++iteracion <= opciones.warmup) return;     // Las corridas de calentamiento no cuentan
+        tokens = 0;
+        for (Medicion& medicion : mediciones) {
+            tokens += medicion.tokens;
+            latencias.insert(latencias.end(), medicion.latencias.begin(), medicion.latencias.end());
+        }
+    });
+
+    Estadisticas tiempo = calcularEstadisticas(tiempos);
+    Estadisticas latencia = calcularEstadisticas(latencias);
+    return {hilos, tiempo, bytes / 1e6 / (tiempo.mediana / 1000.0), tokens / (tiempo.mediana / 1000.0),
+            latencia.mediana, latencia.p99};
+}
+
+struct PruebaClasificador {
+    string nombre;
+    Estadisticas tiempo;            // ms por pasada sobre todos los identificadores
+    size_t palabras;                // Cuántos resultaron keyword o system, para comparar
+};
+
+/*
+Clasifica todos los identificadores del corpus de tres formas: la tabla hash perfecta que usa el
+analizador, la búsqueda binaria sobre las listas ordenadas que usaba antes y regex_match con las
+alternativas keyword y system del original (compiladas una sola vez; resaltarLexico las compilaba
+en cada token). Las tres deben dar la misma categoría a cada identificador; las diferencias se
+suman en diferentes.
+*/
+vector<PruebaClasificador> medirClasificador(const vector<string>& contenidos, const Opciones& opciones, int& diferentes) {
+    vector<string_view> identificadores;
+    for (const string& contenido : contenidos) {
+        size_t pos = 0;
+        Token token;
+        while (siguienteToken(contenido.data(), contenido.size(), pos, token)) {
+            if (token.tipo == KEYWORD || token.tipo == SYSTEM || token.tipo == VARIABLE) {
+                identificadores.push_back(string_view(contenido.data() + token.inicio, token.longitud));
+            }
+        }
+    }
+
+    vector<string_view> keywords, sistema;
+    for (const PalabraReservada& p : PALABRAS_RESERVADAS) {
+        (p.categoria == KEYWORD ? keywords : sistema).push_back(p.nombre);
+    }
+    sort(keywords.begin(), keywords.end());
+    sort(sistema.begin(), sistema.end());
+    regex keyword(REGEX_KEYWORD), system(REGEX_SYSTEM);
+
+    auto clasificarBusqueda = [&](string_view palabra) {
+        if (binary_search(keywords.begin(), keywords.end(), palabra)) return KEYWORD;
+        if (binary_search(sistema.begin(), sistema.end(), palabra)) return SYSTEM;
+        return VARIABLE;
+    };
+    auto clasificarRegex = [&](string_view palabra) {
+        if (regex_match(palabra.begin(), palabra.end(), keyword)) return KEYWORD;
+        if (regex_match(palabra.begin(), palabra.end(), system)) return SYSTEM;
+        return VARIABLE;
+    };
+
+    vector<Categoria> referencia(identificadores.size());
+    for (size_t i = 0; i < identificadores.size(); i++) {
+        referencia[i] = clasificarIdentificador(identificadores[i]);
+        if (clasificarBusqueda(identificadores[i]) != referencia[i] || clasificarRegex(identificadores[i]) != referencia[i]) {
+            cerr << "Clasificacion diferente para: " << identificadores[i] << endl;
+            diferentes++;
+        }
+    }
+
+    vector<PruebaClasificador> pruebas;
+    auto medir = [&](const string& nombre, int warmup, int iteraciones, auto clasificar) {
+        size_t palabras = 0;
+        vector<double> tiempos = repetir(warmup, iteraciones, [&] {
+            palabras = 0;
+            for (string_view identificador : identificadores) palabras += clasificar(identificador) != VARIABLE;
+        });
+        pruebas.push_back({nombre, calcularEstadisticas(tiempos), palabras});
+    };
+    medir("hash_perfecto", opciones.warmup, opciones.iteraciones, clasificarIdentificador);
+    medir("busqueda_binaria", opciones.warmup, opciones.iteraciones, clasificarBusqueda);
+    // std::regex es cientos de veces más lento: con unas cuantas pasadas basta
+    medir("regex", min(opciones.warmup, 1), min(opciones.iteraciones, 3), clasificarRegex);
+
+    cout << ",\n  \"clasificador\": {\"identificadores\": " << identificadores.size() << ", \"pruebas\": [\n";
+    for (size_t i = 0; i < pruebas.size(); i++) {
+        const PruebaClasificador& p = pruebas[i];
+        cout << "    {\"prueba\": \"" << p.nombre << "\", \"mediana_ms\": " << p.tiempo.mediana << ", \"mad_ms\": " << p.tiempo.mad
+             << ", \"ns_identificador\": " << p.tiempo.mediana * 1e6 / max<size_t>(1, identificadores.size())
+             << ", \"reservadas\": " << p.palabras << ", \"speedup_regex\": " << pruebas.back().tiempo.mediana / p.tiempo.mediana << "}"
+             << (i + 1 < pruebas.size() ? "," : "") << "\n";
+    }
+    cout << "  ]}";
+    return pruebas;
+}
+
+vector<int> leerLista(const string& texto) {
+    vector<int> valores;
+    stringstream ss(texto);
+    string valor;
+    while (getline(ss, valor, ',')) {
+        if (atoi(valor.c_str()) > 0) valores.push_back(atoi(valor.c_str()));
+    }
+    return valores;
+}
+
+bool leerOpciones(int argc, char* argv[], Opciones& opciones) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hayValor = i + 1 < argc;
+        if (arg == "--perfil" && hayValor) {
+            opciones.sintetico = true;
+            opciones.nombrePerfil = argv[++i];
+            if (!leerPerfil(opciones.nombrePerfil, opciones.perfil)) {
+                cerr << "Perfil desconocido: " << opciones.nombrePerfil << endl;
+                return false;
+            }
+        } else if (arg == "--corpus" && hayValor) {
+            opciones.directorio = argv[++i];
+        } else if (arg == "--bytes" && hayValor) {
+            opciones.bytes = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--archivos" && hayValor) {
+            opciones.archivos = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--semilla" && hayValor) {
+            opciones.semilla = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--warmup" && hayValor) {
+            opciones.warmup = atoi(argv[++i]);
+        } else if (arg == "--iteraciones" && hayValor) {
+            opciones.iteraciones = max(1, atoi(argv[++i]));
+        } else if (arg == "--hilos" && hayValor) {
+            opciones.hilos = leerLista(argv[++i]);
+        } else if (arg == "--regex") {
+            opciones.regex = true;
+        } else if (arg == "--clasificador") {
+            opciones.clasificador = true;
+        } else {
+            cerr << "Opcion desconocida: " << arg << endl;
+            return false;
+        }
+    }
+
+    // Por omisión: 1, 2, 4, ... hasta el número de núcleos
+    if (opciones.hilos.empty()) {
+        int nucleos = max(1u, thread::hardware_concurrency());
+        for (int h = 1; h < nucleos; h *= 2) opciones.hilos.push_back(h);
+        opciones.hilos.push_back(nucleos);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Opciones opciones;
+    if (!leerOpciones(argc, argv, opciones)) {
+        return 1;
+    }
+
+    vector<string> nombres, contenidos;
+    if (opciones.sintetico) {
+        GeneradorCorpus generador(opciones.perfil, opciones.semilla);
+        contenidos = generador.generar(opciones.bytes, opciones.archivos);
+        nombres.assign(contenidos.size(), opciones.nombrePerfil);
+    } else {
+        for (auto &p : fs::recursive_directory_iterator(opciones.directorio)) {
+            if (fs::is_regular_file(p) && p.path().extension() == ".cs") {
+                ifstream file(p.path());
+                stringstream ss;
+                ss << file.rdbuf();
+                nombres.push_back(p.path().string());
+                contenidos.push_back(ss.str());
+            }
+        }
+    }
+
+    size_t bytes = 0, tokens = 0;
+    vector<size_t> orden(contenidos.size());
+    for (size_t i = 0; i < contenidos.size(); i++) {
+        orden[i] = i;
+        bytes += contenidos[i].size();
+        string html;
+        tokens += resaltarContenido(contenidos[i], html);
+    }
+    sort(orden.begin(), orden.end(), [&](size_t a, size_t b) { return contenidos[a].size() > contenidos[b].size(); });
+
+    vector<Resultado> resultados;
+    for (int hilos : opciones.hilos) {
+        resultados.push_back(medir(contenidos, orden, bytes, hilos, opciones));
+    }
+
+    // Cada nivel del escáner con un hilo; la salida debe ser la misma que con el escalar
+    int diferentes = 0;
+    const char* nivelElegido = escanerActual->nivel;
+    vector<const char*> niveles = nivelesSoportados();
+    vector<string> referencia(contenidos.size());
+    vector<Resultado> porNivel;
+    for (const char* nivel : niveles) {
+        usarEscaner(nivel);
+        for (size_t i = 0; i < contenidos.size(); i++) {
+            string html;
+            resaltarContenido(contenidos[i], html);
+            if (nivel == niveles[0]) {
+                referencia[i] = move(html);
+            } else if (html != referencia[i]) {
+                cerr << "Salida diferente con " << nivel << " para: " << nombres[i] << endl;
+                diferentes++;
+            }
+        }
+        porNivel.push_back(medir(contenidos, orden, bytes, 1, opciones));
+    }
+    usarEscaner(nivelElegido);
+
+    cout << "{\n";
+    cout << "  \"corpus\": {\"origen\": \"" << (opciones.sintetico ? "sintetico" : opciones.directorio) << "\", "
+         << "\"perfil\": \"" << (opciones.sintetico ? opciones.nombrePerfil : "archivos") << "\", "
+         << "\"archivos\": " << contenidos.size() << ", \"bytes\": " << bytes << ", \"tokens\": " << tokens
+         << ", \"semilla\": " << opciones.semilla << "},\n";
+    cout << "  \"warmup\": " << opciones.warmup << ",\n";
+    cout << "  \"iteraciones\": " << opciones.iteraciones << ",\n";
+    cout << "  \"resultados\": [\n";
+    for (size_t i = 0; i < resultados.size(); i++) {
+        const Resultado& r = resultados[i];
+        cout << "    {\"hilos\": " << r.hilos << ", \"mediana_ms\": " << r.tiempo.mediana << ", \"mad_ms\": " << r.tiempo.mad
+             << ", \"ic95_ms\": [" << r.tiempo.icInferior << ", " << r.tiempo.icSuperior << "]"
+             << ", \"mb_s\": " << r.mbPorSegundo << ", \"tokens_s\": " << r.tokensPorSegundo
+             << ", \"latencia_p50_us\": " << r.p50 << ", \"latencia_p99_us\": " << r.p99
+             << ", \"speedup\": " << resultados[0].tiempo.mediana / r.tiempo.mediana << "}"
+             << (i + 1 < resultados.size() ? "," : "") << "\n";
+    }
+    cout << "  ],\n";
+    cout << "  \"simd\": {\"nivel\": \"" << nivelElegido << "\", \"diferentes\": " << diferentes << ", \"niveles\": [\n";
+    for (size_t i = 0; i < porNivel.size(); i++) {
+        const Resultado& r = porNivel[i];
+        cout << "    {\"nivel\": \"" << niveles[i] << "\", \"mediana_ms\": " << r.tiempo.mediana << ", \"mad_ms\": " << r.tiempo.mad
+             << ", \"mb_s\": " << r.mbPorSegundo << ", \"tokens_s\": " << r.tokensPorSegundo
+             << ", \"speedup\": " << porNivel[0].tiempo.mediana / r.tiempo.mediana << "}"
+             << (i + 1 < porNivel.size() ? "," : "") << "\n";
+    }
+    cout << "  ]}";
+
+    // Comparación contra la versión original con std::regex: misma salida y tokens por segundo
+    if (opciones.regex) {
+        size_t tokensRegex = 0;
+        Cronometro cronometro;
+        for (size_t i = 0; i < contenidos.size(); i++) {
+            string tablas, expresiones;
+            tokensRegex += resaltarContenidoRegex(contenidos[i], expresiones);
+            resaltarContenido(contenidos[i], tablas);
+            if (tablas != expresiones) {
+                cerr << "Salida diferente para: " << nombres[i] << endl;
+                diferentes++;
+            }
+        }
+        double segundos = cronometro.milisegundos() / 1000.0;
+        cout << ",\n  \"regex\": {\"diferentes\": " << diferentes << ", \"tokens_s\": " << tokensRegex / segundos
+             << ", \"speedup_tablas\": " << resultados[0].tokensPorSegundo / (tokensRegex / segundos) << "}";
+    }
+    if (opciones.clasificador) {
+        medirClasificador(contenidos, opciones, diferentes);
+    }
+    cout << "\n}" << endl;
+
+    return diferentes == 0 ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+// ===========================================================================================
+// File: cache.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene la caché del modo incremental del resaltador. Guarda en
+//              un manifiesto, por cada archivo de C#, su tamaño, fecha de modificación y el hash
+//              de su contenido (XXH64, implementado aquí) junto con la versión del analizador;
+//              así en la siguiente ejecución se pueden saltar los archivos que no cambiaron.
+//              El manifiesto solo es válido si nadie más escribió en el directorio de salida:
+//              las ejecuciones que no son incrementales lo borran.
+// ===========================================================================================
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+// ---------------------------------------------------------------------------------------------
+// XXH64: hash no criptográfico de 64 bits, muy rápido y con buena dispersión
+// ---------------------------------------------------------------------------------------------
+const uint64_t XXH_PRIMO1 = 0x9E3779B185EBCA87ULL;
+const uint64_t XXH_PRIMO2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t XXH_PRIMO3 = 0x165667B19E3779F9ULL;
+const uint64_t XXH_PRIMO4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t XXH_PRIMO5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotarIzq(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t leer64(const char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t leer32(const char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t xxhRonda(uint64_t acumulado, uint64_t entrada) {
+    acumulado += entrada * XXH_PRIMO2;
+    acumulado = rotarIzq(acumulado, 31);
+    return acumulado * XXH_PRIMO1;
+}
+
+inline uint64_t xxhMezcla(uint64_t acumulado, uint64_t valor) {
+    acumulado ^= xxhRonda(0, valor);
+    return acumulado * XXH_PRIMO1 + XXH_PRIMO4;
+}
+
+inline uint64_t xxh64(std::string_view datos, uint64_t semilla = 0) {
+    const char* p = datos.data();
+    const char* fin = p + datos.size();
+    uint64_t h;
+
+    if (datos.size() >= 32) {
+        uint64_t v1 = semilla + XXH_PRIMO1 + XXH_PRIMO2;
+        uint64_t v2 = semilla + XXH_PRIMO2;
+        uint64_t v3 = semilla;
+        uint64_t v4 = semilla - XXH_PRIMO1;
+        const char* limite = fin - 32;
+        do {
+            v1 = xxhRonda(v1, leer64(p));
+            v2 = xxhRonda(v2, leer64(p + 8));
+            v3 = xxhRonda(v3, leer64(p + 16));
+            v4 = xxhRonda(v4, leer64(p + 24));
+            p += 32;
+        } while (p <= limite);
+        h = rotarIzq(v1, 1) + rotarIzq(v2, 7) + rotarIzq(v3, 12) + rotarIzq(v4, 18);
+        h = xxhMezcla(h, v1);
+        h = xxhMezcla(h, v2);
+        h = xxhMezcla(h, v3);
+        h = xxhMezcla(h, v4);
+    } else {
+        h = semilla + XXH_PRIMO5;
+    }
+
+    h += datos.size();
+    for (; p + 8 <= fin; p += 8) {
+        h ^= xxhRonda(0, leer64(p));
+        h = rotarIzq(h, 27) * XXH_PRIMO1 + XXH_PRIMO4;
+    }
+    if (p + 4 <= fin) {
+        h ^= (uint64_t) leer32(p) * XXH_PRIMO1;
+        h = rotarIzq(h, 23) * XXH_PRIMO2 + XXH_PRIMO3;
+        p += 4;
+    }
+    for (; p < fin; p++) {
+        h ^= (uint8_t) *p * XXH_PRIMO5;
+        h = rotarIzq(h, 11) * XXH_PRIMO1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIMO2;
+    h ^= h >> 29;
+    h *= XXH_PRIMO3;
+    h ^= h >> 32;
+    return h;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Manifiesto de la caché
+// ---------------------------------------------------------------------------------------------
+
+// Lo que se recuerda de cada archivo ya resaltado
+struct EntradaCache {
+    uint64_t hash;
+    uint64_t tamano;
+    int64_t modificado;     // Fecha de modificación en nanosegundos
+};
+
+/*
+Manifiesto en texto plano. La primera línea guarda la firma (versión del analizador y opciones que
+cambian la salida); si no coincide con la actual, la caché completa se descarta. Después viene una
+línea por archivo: hash, tamaño, fecha de modificación y ruta (al final porque puede tener espacios).
+*/
+class CacheResaltado {
+public:
+    CacheResaltado(std::string ruta, std::string firma) : ruta(std::move(ruta)), firma(std::move(firma)) {}
+
+    void cargar() {
+        std::ifstream file(ruta);
+        std::string linea;
+        if (!getline(file, linea) || linea != "resaltador-cache " + firma) {
+            return;
+        }
+        while (getline(file, linea)) {
+            std::istringstream campos(linea);
+            EntradaCache entrada;
+            std::string nombre;
+            campos >> std::hex >> entrada.hash >> std::dec >> entrada.tamano >> entrada.modificado;
+            campos.get();
+            if (campos && getline(campos, nombre)) {
+                entradas[nombre] = entrada;
+            }
+        }
+    }
+
+    // Archivos del manifiesto que se cargó (los de la ejecución anterior)
+    std::vector<std::string> anteriores() const {
+        std::vector<std::string> archivos;
+        for (const auto& [archivo, entrada] : entradas) archivos.push_back(archivo);
+        return archivos;
+    }
+
+    const EntradaCache* buscar(const std::string& archivo) const {
+        auto it = entradas.find(archivo);
+        return it == entradas.end() ? nullptr : &it->second;
+    }
+
+    // Agrega una línea al manifiesto nuevo que se escribirá en guardar()
+    void registrar(const std::string& archivo, const EntradaCache& entrada) {
+        nuevo << std::hex << entrada.hash << std::dec << ' ' << entrada.tamano << ' '
+              << entrada.modificado << ' ' << archivo << '\n';
+    }
+
+    // Escribe primero a un archivo temporal y lo renombra, para no dejar un manifiesto a medias
+    bool guardar() {
+        std::string temporal = ruta + ".tmp";
+        {
+            std::ofstream file(temporal);
+            file << "resaltador-cache " << firma << '\n' << nuevo.str();
+            if (!file) return false;
+        }
+        return rename(temporal.c_str(), ruta.c_str()) == 0;
+    }
+
+private:
+    std::string ruta;
+    std::string firma;
+    std::unordered_map<std::string, EntradaCache> entradas;
+    std::ostringstream nuevo;
+};
+
+#endif
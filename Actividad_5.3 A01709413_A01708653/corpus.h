@@ -0,0 +1,191 @@
+// ===========================================================================================
+// File: corpus.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Generador de código C# sintético para las pruebas de rendimiento del
+//              resaltador. Cada perfil cambia la mezcla de tokens (comentarios, strings,
+//              anidamiento, un solo archivo enorme) y el resultado depende solo de la semilla.
+// ===========================================================================================
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+enum PerfilCorpus {
+    MIXTO,          // Parecido a csharp_examples: clases, métodos, expresiones
+    COMENTARIOS,    // La mayoría de las líneas son comentarios //
+    STRINGS,        // Muchas cadenas largas
+    ANIDADO,        // Bloques y paréntesis muy anidados con mucha sangría
+    GIGANTE,        // Un solo archivo con todo el tamaño pedido (contenido mixto)
+    IDENTIFICADORES // Casi solo identificadores y palabras reservadas
+};
+
+inline bool leerPerfil(const std::string& nombre, PerfilCorpus& perfil) {
+    const char* nombres[] = {"mixto", "comentarios", "strings", "anidado", "gigante", "identificadores"};
+    for (int i = 0; i < 6; i++) {
+        if (nombre == nombres[i]) {
+            perfil = (PerfilCorpus) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+class GeneradorCorpus {
+public:
+    GeneradorCorpus(PerfilCorpus perfil, uint64_t semilla) : perfil(perfil), azar(semilla) {}
+
+    /*
+    Genera archivos cuyo tamaño suma aproximadamente bytesTotales. Los tamaños no son uniformes:
+    siguen una distribución sesgada (muchos archivos pequeños y unos pocos grandes), como en un
+    proyecto real.
+    */
+    std::vector<std::string> generar(size_t bytesTotales, size_t archivos) {
+        if (perfil == GIGANTE) archivos = 1;
+        std::vector<double> pesos(archivos);
+        std::exponential_distribution<double> sesgo(1.0);
+        double suma = 0;
+        for (double& peso : pesos) {
+            peso = archivos == 1 ? 1.0 : sesgo(azar) + 0.05;
+            suma += peso;
+        }
+
+        std::vector<std::string> corpus;
+        for (double peso : pesos) {
+            corpus.push_back(archivo((size_t) (bytesTotales * peso / suma) + 1));
+        }
+        return corpus;
+    }
+
+    std::string archivo(size_t bytes) {
+        std::string texto = "using System;\n\nnamespace Sintetico\n{\n";
+        int clase = 0;
+        while (texto.size() < bytes) {
+            texto += "  public class Clase" + std::to_string(clase++) + "\n  {\n";
+            int metodos = 1 + entero(6);
+            for (int m = 0; m < metodos && texto.size() < bytes; m++) {
+                metodo(texto, m);
+            }
+            texto += "  }\n";
+        }
+        texto += "}\n";
+        return texto;
+    }
+
+private:
+    int entero(int limite) {
+        return std::uniform_int_distribution<int>(0, limite - 1)(azar);
+    }
+
+    const char* elegir(const std::vector<const char*>& opciones) {
+        return opciones[entero(opciones.size())];
+    }
+
+    std::string identificador() {
+        static const std::vector<const char*> bases = {
+            "contador", "valor", "resultado", "indice", "nombre", "total", "lista", "buffer",
+            "temporal", "x", "y", "suma", "Console", "System", "program"
+        };
+        std::string nombre = elegir(bases);
+        if (entero(3) == 0) nombre += std::to_string(entero(100));
+        return nombre;
+    }
+
+    std::string expresion() {
+        static const std::vector<const char*> operadores = {" + ", " - ", " * ", " / ", " % ", " == ", " != ", " && ", " || ", " < ", " >= "};
+        std::string e = identificador();
+        int terminos = 1 + entero(4);
+        for (int i = 0; i < terminos; i++) {
+            e += elegir(operadores);
+            switch (entero(3)) {
+                case 0: e += identificador(); break;
+                case 1: e += std::to_string(entero(10000)); break;
+                default: e += std::to_string(entero(100)) + "." + std::to_string(entero(1000)); break;
+            }
+        }
+        return e;
+    }
+
+    std::string cadena() {
+        static const std::vector<const char*> palabras = {"Hola", "mundo", "valor", "error:", "{0}", "resultado", "\\t", "archivo", "listo"};
+        std::string s = "\"";
+        int n = 1 + entero(perfil == STRINGS ? 12 : 4);
+        for (int i = 0; i < n; i++) {
+            if (i) s += ' ';
+            s += elegir(palabras);
+        }
+        return s + "\"";
+    }
+
+    std::string comentario() {
+        static const std::vector<const char*> palabras = {"TODO", "calcula", "el", "valor", "de", "la", "suma", "para", "cada", "elemento", "del", "arreglo", "revisar"};
+        std::string s = "// ";
+        int n = 3 + entero(10);
+        for (int i = 0; i < n; i++) {
+            s += elegir(palabras);
+            s += ' ';
+        }
+        return s;
+    }
+
+    void sentencia(std::string& texto, const std::string& sangria) {
+        static const std::vector<const char*> tipos = {"int", "double", "string", "var", "bool", "long"};
+        int tipo = entero(10);
+        if (perfil == COMENTARIOS && entero(4) != 0) tipo = 9;
+        if (perfil == STRINGS && entero(3) != 0) tipo = 8;
+        if (perfil == IDENTIFICADORES) tipo = entero(2) == 0 ? 6 : 7;
+
+        switch (tipo) {
+            case 0: case 1: case 2:
+                texto += sangria + elegir(tipos) + " " + identificador() + " = " + expresion() + ";\n";
+                break;
+            case 3:
+                texto += sangria + identificador() + " += " + expresion() + ";\n";
+                break;
+            case 4: case 5:
+                texto += sangria + "Console.WriteLine(" + cadena() + " + " + identificador() + ");\n";
+                break;
+            case 6:
+                texto += sangria + "public static readonly " + elegir(tipos) + " " + identificador() + " = new " + identificador() + "(" + identificador() + ", " + identificador() + ");\n";
+                break;
+            case 7:
+                texto += sangria + "if (" + identificador() + " is " + identificador() + " && this." + identificador() + " != null) return " + identificador() + ";\n";
+                break;
+            case 8:
+                texto += sangria + "string " + identificador() + " = " + cadena() + " + " + cadena() + ";\n";
+                break;
+            default:
+                texto += sangria + comentario() + "\n";
+                break;
+        }
+    }
+
+    void bloque(std::string& texto, const std::string& sangria, int profundidad) {
+        int sentencias = 2 + entero(5);
+        for (int i = 0; i < sentencias; i++) {
+            sentencia(texto, sangria);
+        }
+        int maximo = perfil == ANIDADO ? 12 : 2;
+        if (profundidad < maximo && entero(perfil == ANIDADO ? 4 : 3) != 0) {
+            texto += sangria + (entero(2) ? "for (int i = 0; i < " + identificador() + "; i++)" : "while ((" + expresion() + ") && (" + expresion() + "))") + "\n";
+            texto += sangria + "{\n";
+            bloque(texto, sangria + "    ", profundidad + 1);
+            texto += sangria + "}\n";
+        }
+    }
+
+    void metodo(std::string& texto, int numero) {
+        texto += "    " + comentario() + "\n";
+        texto += "    static void Metodo" + std::to_string(numero) + "(string[] args)\n    {\n";
+        bloque(texto, "      ", 0);
+        texto += "    }\n\n";
+    }
+
+    PerfilCorpus perfil;
+    std::mt19937_64 azar;
+};
+
+#endif
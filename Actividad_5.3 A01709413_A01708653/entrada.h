@@ -0,0 +1,96 @@
+// ===========================================================================================
+// File: entrada.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene la lectura de los archivos de C# del resaltador. Los
+//              archivos regulares se mapean en memoria con mmap, así que el analizador trabaja
+//              directamente sobre las páginas del archivo sin copiar el texto; las tuberías y
+//              la entrada estándar, que no se pueden mapear, se leen con read.
+// ===========================================================================================
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+class ArchivoEntrada {
+public:
+    ArchivoEntrada() = default;
+    ArchivoEntrada(const ArchivoEntrada&) = delete;
+    ArchivoEntrada& operator=(const ArchivoEntrada&) = delete;
+
+    ~ArchivoEntrada() {
+        cerrar();
+    }
+
+    // Abre la ruta indicada; "-" representa la entrada estándar
+    bool abrir(const std::string& ruta) {
+        cerrar();
+        int fd = ruta == "-" ? STDIN_FILENO : open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error al abrir el archivo: " << ruta << std::endl;
+            return false;
+        }
+
+        struct stat info;
+        bool exito = true;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* mapa = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapa != MAP_FAILED) {
+                madvise(mapa, info.st_size, MADV_SEQUENTIAL);
+                datos = (const char*) mapa;
+                tamano = info.st_size;
+                mapeado = true;
+            } else {
+                exito = leerTodo(fd);
+            }
+        } else {
+            exito = leerTodo(fd);
+        }
+
+        if (fd != STDIN_FILENO) close(fd);
+        if (!exito) std::cerr << "Error al leer el archivo: " << ruta << std::endl;
+        return exito;
+    }
+
+    std::string_view contenido() const {
+        return std::string_view(datos, tamano);
+    }
+
+    bool estaMapeado() const {
+        return mapeado;
+    }
+
+    void cerrar() {
+        if (mapeado) munmap((void*) datos, tamano);
+        mapeado = false;
+        datos = nullptr;
+        tamano = 0;
+        respaldo.clear();
+    }
+
+private:
+    // Respaldo para lo que no se puede mapear (tuberías, stdin, archivos vacíos)
+    bool leerTodo(int fd) {
+        char bloque[1 << 16];
+        ssize_t leidos;
+        while ((leidos = read(fd, bloque, sizeof(bloque))) > 0) {
+            respaldo.append(bloque, leidos);
+        }
+        datos = respaldo.data();
+        tamano = respaldo.size();
+        return leidos == 0;
+    }
+
+    const char* datos = nullptr;
+    size_t tamano = 0;
+    bool mapeado = false;
+    std::string respaldo;
+};
+
+#endif
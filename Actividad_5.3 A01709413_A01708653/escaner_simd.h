@@ -0,0 +1,215 @@
+// ===========================================================================================
+// File: escaner_simd.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene los recorridos rápidos que usa el analizador de
+//              resaltador.h dentro de los espacios, los comentarios y los strings, donde no
+//              hace falta ver carácter por carácter: saltar una racha de espacios, buscar el
+//              fin de línea y buscar la última comilla de un tramo. Cada uno tiene una
+//              versión AVX2 (32 bytes por comparación), una SSE4.2 (16 bytes con las
+//              instrucciones de cadenas) y una escalar; se usa la mejor que tenga el
+//              procesador. Fuera de x86 solo se compila la escalar.
+// ===========================================================================================
+#ifndef ESCANER_SIMD_H
+#define ESCANER_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Los mismos espacios que la clase C_ESPACIO del analizador: ' ', '\t', '\n', '\v', '\f' y '\r'
+inline bool esEspacioBlanco(char c) {
+    return c == ' ' || (uint8_t) (c - '\t') <= '\r' - '\t';
+}
+
+// ---------------------------------------------------------------------------- Escalar
+
+// Primera posición desde i que no es espacio (n si todo lo que queda lo es)
+inline size_t saltarEspaciosEscalar(const char* texto, size_t n, size_t i) {
+    while (i < n && esEspacioBlanco(texto[i])) i++;
+    return i;
+}
+
+// Primera posición desde i con '\n' o '\r' (n si ya no hay)
+inline size_t buscarFinLineaEscalar(const char* texto, size_t n, size_t i) {
+    while (i < n && texto[i] != '\n' && texto[i] != '\r') i++;
+    return i;
+}
+
+// Última posición de [desde, hasta) con '"' (hasta si no hay ninguna)
+inline size_t buscarUltimaComillaEscalar(const char* texto, size_t desde, size_t hasta) {
+    for (size_t j = hasta; j > desde; j--) {
+        if (texto[j - 1] == '"') return j - 1;
+    }
+    return hasta;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// ---------------------------------------------------------------------------- AVX2
+
+// Máscara con un bit por cada byte de bloque que es espacio
+__attribute__((target("avx2")))
+inline uint32_t mascaraEspaciosAVX2(__m256i bloque) {
+    __m256i desplazado = _mm256_sub_epi8(bloque, _mm256_set1_epi8('\t'));
+    __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(desplazado, _mm256_set1_epi8('\r' - '\t')), desplazado);
+    __m256i espacio = _mm256_cmpeq_epi8(bloque, _mm256_set1_epi8(' '));
+    return (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(control, espacio));
+}
+
+__attribute__((target("avx2")))
+inline uint32_t mascaraFinLineaAVX2(__m256i bloque) {
+    __m256i salto = _mm256_cmpeq_epi8(bloque, _mm256_set1_epi8('\n'));
+    __m256i retorno = _mm256_cmpeq_epi8(bloque, _mm256_set1_epi8('\r'));
+    return (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(salto, retorno));
+}
+
+/*
+Los recorridos hacia adelante revisan 64 bytes por vuelta (dos bloques de 32) y se detienen en el
+primer bloque con un bit encendido; lo que queda al final del texto, menos de 32 bytes, se revisa
+con la versión escalar para no leer fuera del arreglo.
+*/
+__attribute__((target("avx2")))
+inline size_t saltarEspaciosAVX2(const char* texto, size_t n, size_t i) {
+    for (; i + 64 <= n; i += 64) {
+        uint32_t a = ~mascaraEspaciosAVX2(_mm256_loadu_si256((const __m256i*) (texto + i)));
+        if (a) return i + __builtin_ctz(a);
+        uint32_t b = ~mascaraEspaciosAVX2(_mm256_loadu_si256((const __m256i*) (texto + i + 32)));
+        if (b) return i + 32 + __builtin_ctz(b);
+    }
+    for (; i + 32 <= n; i += 32) {
+        uint32_t a = ~mascaraEspaciosAVX2(_mm256_loadu_si256((const __m256i*) (texto + i)));
+        if (a) return i + __builtin_ctz(a);
+    }
+    return saltarEspaciosEscalar(texto, n, i);
+}
+
+__attribute__((target("avx2")))
+inline size_t buscarFinLineaAVX2(const char* texto, size_t n, size_t i) {
+    for (; i + 64 <= n; i += 64) {
+        uint32_t a = mascaraFinLineaAVX2(_mm256_loadu_si256((const __m256i*) (texto + i)));
+        if (a) return i + __builtin_ctz(a);
+        uint32_t b = mascaraFinLineaAVX2(_mm256_loadu_si256((const __m256i*) (texto + i + 32)));
+        if (b) return i + 32 + __builtin_ctz(b);
+    }
+    for (; i + 32 <= n; i += 32) {
+        uint32_t a = mascaraFinLineaAVX2(_mm256_loadu_si256((const __m256i*) (texto + i)));
+        if (a) return i + __builtin_ctz(a);
+    }
+    return buscarFinLineaEscalar(texto, n, i);
+}
+
+// Hacia atrás, de 32 en 32 desde hasta; el bit más alto de la máscara es la última comilla del bloque
+__attribute__((target("avx2")))
+inline size_t buscarUltimaComillaAVX2(const char* texto, size_t desde, size_t hasta) {
+    __m256i comilla = _mm256_set1_epi8('"');
+    size_t j = hasta;
+    for (; j >= desde + 32; j -= 32) {
+        __m256i bloque = _mm256_loadu_si256((const __m256i*) (texto + j - 32));
+        uint32_t mascara = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(bloque, comilla));
+        if (mascara) return j - 32 + (31 - __builtin_clz(mascara));
+    }
+    size_t ultima = buscarUltimaComillaEscalar(texto, desde, j);
+    return ultima == j ? hasta : ultima;
+}
+
+// ---------------------------------------------------------------------------- SSE4.2
+
+/*
+Con SSE4.2, _mm_cmpestri compara 16 bytes contra un conjunto de hasta 16 caracteres y regresa la
+posición del primero (o del último) que cumple; 16 significa que ninguno. Se usa la versión con
+longitudes explícitas porque la implícita se detendría en un byte 0 del texto.
+*/
+__attribute__((target("sse4.2")))
+inline size_t saltarEspaciosSSE42(const char* texto, size_t n, size_t i) {
+    const __m128i espacios = _mm_setr_epi8(' ', '\t', '\n', '\v', '\f', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (; i + 16 <= n; i += 16) {
+        __m128i bloque = _mm_loadu_si128((const __m128i*) (texto + i));
+        int k = _mm_cmpestri(espacios, 6, bloque, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+        if (k < 16) return i + k;
+    }
+    return saltarEspaciosEscalar(texto, n, i);
+}
+
+__attribute__((target("sse4.2")))
+inline size_t buscarFinLineaSSE42(const char* texto, size_t n, size_t i) {
+    const __m128i finesLinea = _mm_setr_epi8('\n', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (; i + 16 <= n; i += 16) {
+        __m128i bloque = _mm_loadu_si128((const __m128i*) (texto + i));
+        int k = _mm_cmpestri(finesLinea, 2, bloque, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+        if (k < 16) return i + k;
+    }
+    return buscarFinLineaEscalar(texto, n, i);
+}
+
+__attribute__((target("sse4.2")))
+inline size_t buscarUltimaComillaSSE42(const char* texto, size_t desde, size_t hasta) {
+    const __m128i comilla = _mm_setr_epi8('"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    size_t j = hasta;
+    for (; j >= desde + 16; j -= 16) {
+        __m128i bloque = _mm_loadu_si128((const __m128i*) (texto + j - 16));
+        int k = _mm_cmpestri(comilla, 1, bloque, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_MOST_SIGNIFICANT);
+        if (k < 16) return j - 16 + k;
+    }
+    size_t ultima = buscarUltimaComillaEscalar(texto, desde, j);
+    return ultima == j ? hasta : ultima;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------- Selección
+
+// Los tres recorridos de un mismo nivel
+struct EscanerTexto {
+    const char* nivel;
+    size_t (*saltarEspacios)(const char*, size_t, size_t);
+    size_t (*buscarFinLinea)(const char*, size_t, size_t);
+    size_t (*buscarUltimaComilla)(const char*, size_t, size_t);
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+const EscanerTexto ESCANER_AVX2 = {"avx2", saltarEspaciosAVX2, buscarFinLineaAVX2, buscarUltimaComillaAVX2};
+const EscanerTexto ESCANER_SSE42 = {"sse4.2", saltarEspaciosSSE42, buscarFinLineaSSE42, buscarUltimaComillaSSE42};
+#endif
+const EscanerTexto ESCANER_ESCALAR = {"escalar", saltarEspaciosEscalar, buscarFinLineaEscalar, buscarUltimaComillaEscalar};
+
+// Niveles que soporta este procesador, del escalar al mejor
+inline std::vector<const char*> nivelesSoportados() {
+    std::vector<const char*> niveles = {"escalar"};
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("sse4.2")) niveles.push_back("sse4.2");
+    if (__builtin_cpu_supports("avx2")) niveles.push_back("avx2");
+#endif
+    return niveles;
+}
+
+// Nombre del mejor nivel que soporta este procesador
+inline const char* nivelSimd() {
+    return nivelesSoportados().back();
+}
+
+// Escáner por nombre ("avx2", "sse4.2" o "escalar"); cualquier otro nombre da el escalar
+inline const EscanerTexto* escanerPorNivel(const char* nivel) {
+    std::string nombre = nivel;
+#if defined(__x86_64__) || defined(__i386__)
+    if (nombre == "avx2") return &ESCANER_AVX2;
+    if (nombre == "sse4.2") return &ESCANER_SSE42;
+#endif
+    return &ESCANER_ESCALAR;
+}
+
+/*
+Escáner que usa el analizador. Se elige al arrancar según el procesador; las pruebas de
+rendimiento lo pueden cambiar con usarEscaner, pero solo mientras ningún hilo esté analizando.
+*/
+inline const EscanerTexto* escanerActual = escanerPorNivel(nivelSimd());
+
+inline void usarEscaner(const char* nivel) {
+    escanerActual = escanerPorNivel(nivel);
+}
+
+#endif
@@ -0,0 +1,133 @@
+// ===========================================================================================
+// File: escritor.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene la escritura de los archivos HTML del resaltador. Cada
+//              hilo puede escribir directamente su propio archivo (sin candados, porque cada
+//              archivo de salida es distinto) o mandar el documento a un hilo escritor que
+//              toma los pendientes de una cola acotada y los escribe por lotes.
+// ===========================================================================================
+#ifndef ESCRITOR_H
+#define ESCRITOR_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// Escribe datos en la ruta indicada con llamadas directas al sistema operativo
+inline bool escribirArchivo(const std::string& ruta, std::string_view datos) {
+    int fd = open(ruta.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error al crear el archivo: " << ruta << std::endl;
+        return false;
+    }
+    size_t escrito = 0;
+    while (escrito < datos.size()) {
+        ssize_t r = write(fd, datos.data() + escrito, datos.size() - escrito);
+        if (r <= 0) {
+            std::cerr << "Error al escribir el archivo: " << ruta << std::endl;
+            close(fd);
+            return false;
+        }
+        escrito += r;
+    }
+    close(fd);
+    return true;
+}
+
+// Documento pendiente de escribir
+struct Salida {
+    std::string ruta;
+    std::string contenido;
+};
+
+/*
+Etapa de escritura asíncrona. Los hilos que resaltan (varios productores) dejan sus documentos en
+una cola acotada a capacidad elementos y un solo hilo escritor (consumidor) los saca todos de una
+vez y los escribe fuera del candado. El candado solo protege el movimiento de los elementos, nunca
+la entrada/salida; si la cola está llena los productores esperan, lo que limita la memoria usada.
+*/
+class EscritorAsincrono {
+public:
+    explicit EscritorAsincrono(size_t capacidad) : capacidad(capacidad) {
+        pthread_create(&hilo, NULL, ejecutar, this);
+    }
+
+    ~EscritorAsincrono() {
+        terminar();
+    }
+
+    void encolar(Salida salida) {
+        std::unique_lock<std::mutex> lock(mtx);
+        hayEspacio.wait(lock, [this] { return pendientes.size() < capacidad; });
+        pendientes.push_back(std::move(salida));
+        hayTrabajo.notify_one();
+    }
+
+    // Espera a que se escriba todo lo encolado hasta ahora sin detener el hilo escritor
+    void vaciar() {
+        std::unique_lock<std::mutex> lock(mtx);
+        vacio.wait(lock, [this] { return pendientes.empty() && !escribiendo; });
+    }
+
+    // Espera a que se escriba todo lo pendiente y detiene el hilo escritor
+    void terminar() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (detenido) return;
+            detenido = true;
+        }
+        hayTrabajo.notify_one();
+        pthread_join(hilo, NULL);
+    }
+
+    size_t lotes = 0;       // Número de veces que el escritor vació la cola
+    size_t archivos = 0;
+
+private:
+    static void* ejecutar(void* arg) {
+        EscritorAsincrono* escritor = (EscritorAsincrono*) arg;
+        std::vector<Salida> lote;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(escritor->mtx);
+                escritor->hayTrabajo.wait(lock, [escritor] {
+                    return !escritor->pendientes.empty() || escritor->detenido;
+                });
+                if (escritor->pendientes.empty()) break;
+                lote.swap(escritor->pendientes);
+                escritor->escribiendo = true;
+            }
+            escritor->hayEspacio.notify_all();
+
+            for (Salida& salida : lote) {
+                escribirArchivo(salida.ruta, salida.contenido);
+            }
+            escritor->lotes++;
+            escritor->archivos += lote.size();
+            lote.clear();
+            {
+                std::lock_guard<std::mutex> lock(escritor->mtx);
+                escritor->escribiendo = false;
+            }
+            escritor->vacio.notify_all();
+        }
+        return nullptr;
+    }
+
+    size_t capacidad;
+    std::vector<Salida> pendientes;
+    std::mutex mtx;
+    std::condition_variable hayTrabajo, hayEspacio, vacio;
+    bool detenido = false;
+    bool escribiendo = false;   // El hilo escritor tiene un lote fuera del candado
+    pthread_t hilo;
+};
+
+#endif
@@ -3,176 +3,561 @@
 // Author: María Fernanda Moreno Gómez A01708653
 //         Uri Jared Gopar Morales  A01709413
 // Description: Este archivo contiene el código para realizar el resaltador de sintaxis de C# 
-//              en C++, utilizando expresiones regulares para cada categoría léxica.
-//              To compile: g++ -std=c++17 resaltador.cpp -lpthread -o app   y después  .\app
+//              en C++. Cada categoría léxica se reconoce con el analizador basado en tablas
+//              de resaltador.h, en una sola pasada sobre el archivo.
+//              To compile: g++ -std=c++17 resaltador.cpp -lpthread -o app   y después  .\app [opciones]  (ver leerOpciones)
 // ===========================================================================================
 #include <iostream>
-#include <fstream>
 #include <vector>
-#include <regex>
 #include <filesystem>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <unordered_set>
 #include <mutex>
-#include "utils.h"
+#include <condition_variable>
+#include <cstdlib>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <csignal>
+#include "../comun/perfilador.h"
+#include "resaltador.h"
+#include "escritor.h"
+#include "entrada.h"
+#include "cache.h"
+#include "vigilancia.h"
 
 using namespace std;
 namespace fs = std::filesystem;
 
-const int THREADS = 8;  
-mutex mtx;
+// Los archivos con al menos umbralDivision bytes se dividen en hilosPorArchivo fragmentos. Lo fija
+// resaltarEnParalelo (o PoolResaltado) para cada lote (ver presupuestoDivision); la secuencial no divide
+size_t umbralDivision = 1 << 20;
+int hilosPorArchivo = 1;
 
-struct Block {
-    int start, end;
-    vector<string>* array;
+// Si --async-io está activo, los documentos se mandan a este hilo escritor en lugar de
+// escribirse desde el hilo que los generó
+bool escrituraAsincrona = false;
+EscritorAsincrono* escritor = nullptr;
+
+// --compact: omite los <span class=""> de los espacios y une tokens seguidos de la misma categoría
+bool salidaCompacta = false;
+
+// "-": resalta stdin hacia stdout en lugar de recorrer csharp_examples
+bool desdeEntradaEstandar = false;
+
+// --incremental: solo se resaltan los archivos que cambiaron desde la ejecución anterior
+// (según el manifiesto de cache.h); --force vuelve a resaltar todo aunque no hayan cambiado
+bool incremental = false;
+bool forzar = false;
+CacheResaltado* cache = nullptr;
+
+// --watch [DIR]: se queda vigilando el directorio y vuelve a resaltar los archivos que se guarden;
+// --debounce MS es el tiempo sin eventos nuevos que se espera antes de procesar una ráfaga
+bool vigilar = false;
+string directorioVigilado = "./csharp_examples";
+int silencioMs = 50;
+volatile sig_atomic_t interrumpido = 0;
+
+// --warmup N y --repeticiones N: corridas sin medir y corridas medidas de la comparación entre la
+// ejecución paralela y la secuencial (se reporta la mediana); --formato json|csv cambia el reporte
+int warmup = 0;
+int repeticiones = 1;
+FormatoReporte formato = TEXTO;
+
+// Archivo pendiente de resaltar junto con su tamaño en bytes
+struct Archivo {
+    string ruta;
+    uintmax_t tamano;
+    int64_t modificado;     // Fecha de modificación en nanosegundos
+    uint64_t hash;          // Hash del contenido (solo en modo incremental)
+    bool omitido;           // No cambió desde la última ejecución y no se volvió a resaltar
+};
+
+/*
+Cola de archivos compartida por todos los hilos. Los archivos se ordenan de mayor a menor tamaño y
+cada hilo toma el siguiente con un contador atómico, así los archivos grandes se reparten primero
+y los pequeños rellenan los huecos al final (en lugar de bloques fijos por número de archivos).
+*/
+struct ColaArchivos {
+    vector<Archivo> archivos;
+    atomic<size_t> siguiente{0};
+
+    explicit ColaArchivos(vector<Archivo> lista) : archivos(move(lista)) {
+        stable_sort(archivos.begin(), archivos.end(), [](const Archivo& a, const Archivo& b) {
+            return a.tamano > b.tamano;
+        });
+    }
+
+    Archivo* tomar() {
+        size_t i = siguiente.fetch_add(1, memory_order_relaxed);
+        return i < archivos.size() ? &archivos[i] : nullptr;
+    }
+};
+
+// Datos de cada hilo: la cola de la que toma trabajo y dónde registra cuánto tardó en cada archivo
+struct Trabajador {
+    ColaArchivos* cola;
+    VueltasPorHilo* vueltas;    // ms dentro de resaltarLexico por archivo
+    const string* directorioSalida;
+    int indice;
 };
 
-void resaltarLexico(const string& archivo, const string& directorioSalida) {
-    ifstream file(archivo);
-    if (!file) {
-        cerr << "Error al abrir el archivo: " << archivo << endl;
+string rutaDeSalida(const string& archivo, const string& directorioSalida) {
+    return directorioSalida + fs::path(archivo).filename().string() + ".html";
+}
+
+void resaltarLexico(Archivo& archivo, const string& directorioSalida) {
+    string rutaSalida = rutaDeSalida(archivo.ruta, directorioSalida);
+    archivo.omitido = false;
+
+    // Modo incremental: si el tamaño y la fecha no cambiaron ni siquiera se abre el archivo
+    const EntradaCache* anterior = cache ? cache->buscar(archivo.ruta) : nullptr;
+    if (anterior && !forzar && anterior->tamano == archivo.tamano && anterior->modificado == archivo.modificado
+        && fs::exists(rutaSalida)) {
+        archivo.hash = anterior->hash;
+        archivo.omitido = true;
         return;
     }
 
-    stringstream ss;
-    ss << file.rdbuf();
-    string contenido = ss.str();
-
-    // Define las expresiones regulares
-    string comentarios = "//.*\n?";
-    string keyword = "\\b(abstract|as|base|bool|break|byte|case|catch|char|checked|class|const|continue|decimal|default|delegate|do|double|else|enum|event|explicit|extern|false|finally|fixed|float|for|foreach|goto|if|implicit|in|int|interface|internal|is|lock|long|namespace|new|null|object|operator|out|override|params|private|protected|public|readonly|ref|return|sbyte|sealed|short|sizeof|stackalloc|static|string|struct|switch|this|throw|true|try|typeof|uint|ulong|unchecked|unsafe|ushort|using|virtual|void|volatile|while)\\b";
-    string operadores = "\\+|-|\\*|/|%|\\^|&|\\||~|!|=|<|>|\\?|:|;|,|\\.|\\+\\+|--|&&|\\|\\||==|!=|<=|>=|\\+=|-=|\\*=|/=|%\\=|\\^=|&\\=|\\|=|<<=|>>=|=>|\\?\\?";
-    string reales = "-*[0-9]+\\.[0-9]+([E][-*][0-9]+)?|-*[0-9]+(\\.[0-9]+)?";
-    string especiales = "[\\(\\)|!]";
-    string espacios = "\\s+";
-    string variable = "[a-zA-Z][a-zA-Z_0-9]*";
-    string lineBreak = "\n";
-    string strings = "\".*\"";
-    string system = "\\b(System|Console|Program|program)\\b";
-    string separators = "[\\(\\)\\{\\}\\[\\];,.]";
-
-    string resaltado;
-    resaltado += "<style>"  
-                    ".Variable { color: blue; }"
-                    ".Real { color: green; }"
-                    ".Comentario { color: gray; }"
-                    ".Especial { color: red; }"
-                    ".Operador { color: purple; }"
-                    ".Keyword { color: cyan; }"
-                    ".body { backgroud-color: black;   }"
-                    ".System { color: orange; }" // color para las palabras clave del sistema
-                    ".Separators { color: red; }"
-                    ".String { color: pink; }"
-                    "</style>";
-    resaltado += "<pre>";
-// Asegurarte de que keyword y variable se verifiquen primero
-regex regex_tokens(keyword + "|" + comentarios + "|" + strings + "|" + variable + "|" + reales + "|" + especiales + "|" + operadores + "|" + separators + "|" + system + "|" + espacios + "|" + lineBreak);
-
-// Asegurarte de que keyword se verifique antes que variable
-for (sregex_iterator it(contenido.begin(), contenido.end(), regex_tokens); it != sregex_iterator(); ++it) {
-    string token = it->str();
-    string tipoToken;
-
-    if (regex_match(token, regex(lineBreak))) {
-        resaltado += "</pre><pre>";
-    } else if (regex_match(token, regex(comentarios))) {
-        tipoToken = "Comentario";
-    } else if (regex_match(token, regex(keyword))) {
-        tipoToken = "Keyword";
-    }else if (regex_match(token, regex(system))) {
-        tipoToken = "System";
-    }else if (regex_match(token, regex(separators))) {
-        tipoToken = "Separators";
-    }else if (regex_match(token, regex(strings))) {
-        tipoToken = "String";
-    } else if (regex_match(token, regex(variable))) {
-        tipoToken = "Variable";
-    } else if (regex_match(token, regex(operadores))) {
-        tipoToken = "Operador";
-    } else if (regex_match(token, regex(reales))) {
-        tipoToken = "Real";
-    } else if (regex_match(token, regex(especiales))) {
-        tipoToken = "Especial";
-    } else {
-        tipoToken = ""; // Espacios no deben ser resaltados
+    // El archivo se mapea en memoria: los tokens apuntan directo a sus páginas, sin copias
+    ArchivoEntrada entrada;
+    if (!entrada.abrir(archivo.ruta)) {
+        return;
     }
+    string_view contenido = entrada.contenido();
 
-    if (token != "\n") {
-         resaltado += "<span class=\"" + tipoToken + "\">" + token + "</span>";
+    // Si solo cambió la fecha, el hash del contenido decide
+    if (cache) {
+        archivo.hash = xxh64(contenido);
+        if (anterior && !forzar && anterior->hash == archivo.hash && fs::exists(rutaSalida)) {
+            archivo.omitido = true;
+            return;
+        }
     }
-}
-    resaltado += "</pre>";
 
-    lock_guard<mutex> lock(mtx);
-    string nombreArchivo = fs::path(archivo).filename().string();
-    ofstream outFile(directorioSalida + nombreArchivo + ".html");
-    outFile << resaltado;
-    outFile.close();
+    // Un solo recorrido del analizador léxico de resaltador.h genera todo el documento; los
+    // archivos muy grandes se reparten en fragmentos que se analizan en paralelo. El búfer de
+    // salida es propio de cada hilo y se reutiliza de un archivo a otro
+    thread_local EmisorHTML emisor;
+    emisor.compacto = salidaCompacta;
+    emisor.reiniciar(capacidadEsperada(contenido.size()));
+    if (hilosPorArchivo > 1 && contenido.size() >= umbralDivision) {
+        resaltarContenidoPorPartes(contenido, buscarCortes(contenido, hilosPorArchivo), emisor);
+    } else {
+        resaltarContenido(contenido, emisor);
+    }
+
+    // Cada archivo de salida es distinto, así que no hace falta ningún candado para escribirlo
+    if (escritor) {
+        escritor->encolar({move(rutaSalida), string(emisor.vista())});
+    } else {
+        escribirArchivo(rutaSalida, emisor.vista());
+    }
 } 
 
 void *resaltar(void* arg) {
-    Block* data = (Block*) arg;
-    string directorioSalida = "./output/";
-    for (int i = data->start; i < data->end; ++i) {
-        string archivo = (*data->array)[i];
-        resaltarLexico(archivo, directorioSalida);
+    Trabajador* data = (Trabajador*) arg;
+    while (Archivo* archivo = data->cola->tomar()) {
+        Cronometro cronometro;
+        resaltarLexico(*archivo, *data->directorioSalida);
+        data->vueltas->registrar(data->indice, cronometro.milisegundos());
     }
     return nullptr;
 }
 
-int main() {
-    vector<string> archivos;
+/*
+Fragmentos para cada archivo grande de un lote que se resalta con hilos trabajadores. Cada
+trabajador que toma un archivo grande crea sus propios hilos para los fragmentos, así que los hilos
+se reparten entre los archivos grandes: si cada uno usara hilos fragmentos habría hasta hilos^2
+hilos compitiendo por los núcleos.
+*/
+int presupuestoDivision(const vector<Archivo>& archivos, int hilos) {
+    size_t grandes = 0;
+    for (const Archivo& archivo : archivos) {
+        grandes += archivo.tamano >= umbralDivision;
+    }
+    return max(1, hilos / (int) max<size_t>(1, grandes));
+}
+
+/*
+Resalta todos los archivos de la cola con el número de hilos indicado, escribe cada HTML en
+directorioSalida y regresa el tiempo que tardó en ms. Si detalle es true imprime el tiempo ocupado
+e inactivo de cada hilo. Si se da latencias, ahí se agregan los ms que tardó cada archivo.
+*/
+double resaltarEnParalelo(ColaArchivos& cola, const string& directorioSalida, int hilos, bool detalle, vector<double>* latencias = nullptr) {
+    vector<pthread_t> threads(hilos);
+    VueltasPorHilo vueltas(hilos);
+    vector<Trabajador> trabajadores(hilos);
+    Cronometro cronometro;
+    hilosPorArchivo = presupuestoDivision(cola.archivos, hilos);
+
+    if (escrituraAsincrona) {
+        escritor = new EscritorAsincrono(4 * hilos);
+    }
+
+    for (int i = 0; i < hilos; ++i) {
+        trabajadores[i] = {&cola, &vueltas, &directorioSalida, i};
+        pthread_create(&threads[i], NULL, resaltar, (void*)&trabajadores[i]);
+    }
+
+    for (int i = 0; i < hilos; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // El tiempo paralelo incluye terminar de escribir lo que quedó en la cola
+    size_t lotes = 0;
+    if (escritor) {
+        escritor->terminar();
+        lotes = escritor->lotes;
+        delete escritor;
+        escritor = nullptr;
+    }
+    double tiempoParalelo = cronometro.milisegundos();
+    if (latencias) {
+        vector<double> todas = vueltas.todas();
+        latencias->insert(latencias->end(), todas.begin(), todas.end());
+    }
+
+    if (detalle) {
+        cout << "Tiempo de ejecucion paralelo (" << hilos << " hilos): " << tiempoParalelo << " ms" << endl;
+        if (escrituraAsincrona) {
+            cout << "  Escritor asincrono: " << cola.archivos.size() << " archivos en " << lotes << " lotes" << endl;
+        }
+
+        // Tiempo ocupado e inactivo de cada hilo durante la ejecución paralela
+        for (int i = 0; i < hilos; ++i) {
+            cout << "  Hilo " << i << ": " << vueltas.de(i).size() << " archivos, ocupado "
+                 << vueltas.total(i) << " ms, inactivo "
+                 << max(0.0, tiempoParalelo - vueltas.total(i)) << " ms" << endl;
+        }
+    }
+    return tiempoParalelo;
+}
+
+/*
+Lee las opciones de la línea de comandos:
+  --threads N (o -t N)  número de hilos; por omisión los núcleos disponibles
+  --split BYTES         tamaño a partir del cual un archivo se analiza en fragmentos paralelos
+  --async-io            escribe los HTML desde un hilo escritor dedicado
+  --compact             genera un HTML más ligero (ver EmisorHTML en resaltador.h)
+  -                     resalta la entrada estándar y escribe el HTML en la salida estándar
+  --incremental         una sola pasada paralela que salta los archivos sin cambios
+  --force               con --incremental, vuelve a resaltar todos los archivos
+  --watch [DIR]         vigila DIR (csharp_examples por omisión) y resalta lo que se guarde
+  --debounce MS         ms sin eventos nuevos antes de procesar los cambios (50 por omisión)
+  --warmup N            corridas sin medir antes de comparar paralelo contra secuencial
+  --repeticiones N      corridas medidas de cada versión; se reporta la mediana
+  --formato F           texto (por omisión), json o csv
+*/
+int leerOpciones(int argc, char* argv[]) {
+    int hilos = thread::hardware_concurrency();
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if ((arg == "--threads" || arg == "-t") && i + 1 < argc) {
+            hilos = atoi(argv[++i]);
+        } else if (arg == "--split" && i + 1 < argc) {
+            umbralDivision = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--async-io") {
+            escrituraAsincrona = true;
+        } else if (arg == "--compact") {
+            salidaCompacta = true;
+        } else if (arg == "--incremental") {
+            incremental = true;
+        } else if (arg == "--force") {
+            forzar = true;
+        } else if (arg == "--watch") {
+            vigilar = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                directorioVigilado = argv[++i];
+            }
+        } else if (arg == "--debounce" && i + 1 < argc) {
+            silencioMs = atoi(argv[++i]);
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            warmup = max(0, atoi(argv[++i]));
+        } else if (arg == "--repeticiones" && i + 1 < argc) {
+            repeticiones = max(1, atoi(argv[++i]));
+        } else if (arg == "--formato" && i + 1 < argc) {
+            if (!leerFormato(argv[++i], formato)) {
+                cerr << "Formato desconocido: " << argv[i] << endl;
+            }
+        } else if (arg == "-") {
+            desdeEntradaEstandar = true;
+        }
+    }
+    return hilos > 0 ? hilos : 8;
+}
+
+// Llena los datos de un archivo de C# (tamaño y fecha de modificación) a partir de su ruta
+bool datosArchivo(const string& ruta, Archivo& archivo) {
+    struct stat info;
+    if (stat(ruta.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+    int64_t modificado = (int64_t) info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+    archivo = {ruta, (uintmax_t) info.st_size, modificado, 0, false};
+    return true;
+}
+
+void detener(int) {
+    interrumpido = 1;
+}
+
+/*
+Hilos trabajadores del modo de vigilancia. Se crean una sola vez al empezar a vigilar y duermen en
+una variable de condición hasta que llega un lote, en lugar de crear y unir hilos en cada ráfaga de
+guardados; con --async-io el hilo escritor también vive lo mismo que el pool.
+*/
+class PoolResaltado {
+public:
+    PoolResaltado(const string& directorioSalida, int hilos) : directorioSalida(directorioSalida), hilos(hilos) {
+        if (escrituraAsincrona) {
+            escritor = new EscritorAsincrono(4 * hilos);
+        }
+        for (int i = 0; i < hilos; ++i) {
+            pthread_t hilo;
+            if (pthread_create(&hilo, NULL, trabajar, this) == 0) threads.push_back(hilo);
+        }
+    }
+
+    ~PoolResaltado() {
+        {
+            lock_guard<mutex> lock(mtx);
+            detenido = true;
+        }
+        hayLote.notify_all();
+        for (pthread_t hilo : threads) {
+            pthread_join(hilo, NULL);
+        }
+        delete escritor;
+        escritor = nullptr;
+    }
+
+    // Resalta todos los archivos de la cola y regresa cuando sus HTML ya están escritos
+    void procesar(ColaArchivos& cola) {
+        hilosPorArchivo = presupuestoDivision(cola.archivos, hilos);
+        if (threads.empty()) {
+            while (Archivo* archivo = cola.tomar()) resaltarLexico(*archivo, directorioSalida);
+        } else {
+            unique_lock<mutex> lock(mtx);
+            actual = &cola;
+            activos = threads.size();
+            lote++;
+            hayLote.notify_all();
+            terminado.wait(lock, [this] { return activos == 0; });
+        }
+        if (escritor) escritor->vaciar();
+    }
+
+private:
+    static void* trabajar(void* arg) {
+        PoolResaltado* pool = (PoolResaltado*) arg;
+        uint64_t visto = 0;
+        while (true) {
+            ColaArchivos* cola;
+            {
+                unique_lock<mutex> lock(pool->mtx);
+                pool->hayLote.wait(lock, [&] { return pool->lote != visto || pool->detenido; });
+                if (pool->detenido) return nullptr;
+                visto = pool->lote;
+                cola = pool->actual;
+            }
+            while (Archivo* archivo = cola->tomar()) {
+                resaltarLexico(*archivo, pool->directorioSalida);
+            }
+            lock_guard<mutex> lock(pool->mtx);
+            if (--pool->activos == 0) pool->terminado.notify_one();
+        }
+    }
+
+    string directorioSalida;
+    int hilos;
+    vector<pthread_t> threads;
+    mutex mtx;
+    condition_variable hayLote, terminado;
+    ColaArchivos* actual = nullptr;
+    size_t activos = 0;         // Hilos que no han terminado el lote actual
+    uint64_t lote = 0;          // Número del lote actual; cada hilo recuerda el último que procesó
+    bool detenido = false;
+};
+
+/*
+Modo de vigilancia: cada ráfaga de guardados se resalta con el pool y, al terminar, se registra la
+latencia de cada archivo desde su primer evento hasta que su HTML quedó escrito. Con Ctrl+C se
+imprime el histograma de latencias y el programa termina.
+*/
+int vigilarDirectorio(const string& directorioSalida, int hilos) {
+    Vigilante vigilante;
+    if (!vigilante.iniciar(directorioVigilado)) {
+        return 1;
+    }
+
+    // Sin SA_RESTART, para que la señal interrumpa la espera de eventos
+    struct sigaction accion = {};
+    accion.sa_handler = detener;
+    sigaction(SIGINT, &accion, nullptr);
+    sigaction(SIGTERM, &accion, nullptr);
+
+    cout << "Vigilando " << directorioVigilado << " (Ctrl+C para terminar)" << endl;
+    PoolResaltado pool(directorioSalida, hilos);
+    HistogramaLatencia histograma;
+    ArchivosTocados tocados;
+    while (!interrumpido && vigilante.esperarCambios(silencioMs, 10 * silencioMs, tocados)) {
+        vector<Archivo> archivos;
+        for (auto& [ruta, evento] : tocados) {
+            Archivo archivo;
+            if (datosArchivo(ruta, archivo)) archivos.push_back(archivo);
+        }
+        if (archivos.empty()) continue;
+
+        ColaArchivos cola(move(archivos));
+        pool.procesar(cola);
+        auto fin = chrono::steady_clock::now();
+
+        double peor = 0;
+        for (const Archivo& archivo : cola.archivos) {
+            chrono::duration<double, micro> latencia = fin - tocados[archivo.ruta];
+            histograma.registrar(latencia.count());
+            peor = max(peor, latencia.count());
+        }
+        cout << "Actualizados " << cola.archivos.size() << " archivos (latencia maxima " << peor / 1000.0 << " ms)" << endl;
+    }
+
+    histograma.imprimir(cout);
+    return 0;
+}
+
+// Memoria residente máxima del proceso, en KB
+long memoriaMaxima() {
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss;
+}
+
+int main(int argc, char* argv[]) {
+    const int hilos = leerOpciones(argc, argv);
+
+    if (desdeEntradaEstandar) {
+        ArchivoEntrada entrada;
+        if (!entrada.abrir("-")) {
+            return 1;
+        }
+        EmisorHTML emisor(salidaCompacta);
+        emisor.reiniciar(capacidadEsperada(entrada.contenido().size()));
+        resaltarContenido(entrada.contenido(), emisor);
+        string_view html = emisor.vista();
+        while (!html.empty()) {
+            ssize_t escrito = write(STDOUT_FILENO, html.data(), html.size());
+            if (escrito <= 0) return 1;
+            html.remove_prefix(escrito);
+        }
+        return 0;
+    }
+
+    vector<Archivo> archivos;
     string directorioSalida = "./output/";
     if (!fs::exists(directorioSalida)) {
         fs::create_directory(directorioSalida);
     }
 
-        for (auto &p : fs::recursive_directory_iterator("./csharp_examples")) {
-        if (fs::is_regular_file(p) && p.path().extension() == ".cs") {
-            archivos.push_back(p.path().string());
+    // Cualquier ejecución que no es incremental reescribe los HTML sin registrar con qué opciones, así
+    // que el manifiesto deja de describirlos y la siguiente incremental debe regenerar todo
+    string rutaManifiesto = directorioSalida + ".resaltador.cache";
+    if (!incremental) {
+        fs::remove(rutaManifiesto);
+    }
+
+    if (vigilar) {
+        return vigilarDirectorio(directorioSalida, hilos);
+    }
+
+    for (auto &p : fs::recursive_directory_iterator("./csharp_examples")) {
+        Archivo archivo;
+        if (p.path().extension() == ".cs" && datosArchivo(p.path().string(), archivo)) {
+            archivos.push_back(archivo);
         }
     }
-    
 
-    // Inicio de la ejecución paralela
-    int blockSize = archivos.size() / THREADS;
-    pthread_t threads[THREADS];
-    Block blocks[THREADS];
+    if (incremental) {
+        string firma = "v" + to_string(VERSION_ANALIZADOR) + (salidaCompacta ? " compacto" : " normal");
+        CacheResaltado manifiesto(rutaManifiesto, firma);
+        manifiesto.cargar();
+        cache = &manifiesto;
 
-    start_timer();      
+        Cronometro cronometro;
+        ColaArchivos cola(move(archivos));
+        resaltarEnParalelo(cola, directorioSalida, hilos, false);
 
-    for (int i = 0; i < THREADS; ++i) {
-        blocks[i].start = i * blockSize;
-        blocks[i].end = (i == THREADS - 1) ? archivos.size() : (i + 1) * blockSize;
-        blocks[i].array = &archivos;
+        size_t omitidos = 0;
+        unordered_set<string> salidas;
+        for (const Archivo& archivo : cola.archivos) {
+            omitidos += archivo.omitido;
+            manifiesto.registrar(archivo.ruta, {archivo.hash, archivo.tamano, archivo.modificado});
+            salidas.insert(rutaDeSalida(archivo.ruta, directorioSalida));
+        }
+        manifiesto.guardar();
 
-        pthread_create(&threads[i], NULL, resaltar, (void*)&blocks[i]);
-    }
+        // Los HTML de archivos que ya no existen se borran (salvo que otro archivo con el mismo nombre lo use)
+        size_t borrados = 0;
+        for (const string& ruta : manifiesto.anteriores()) {
+            string salida = rutaDeSalida(ruta, directorioSalida);
+            if (!fs::exists(ruta) && !salidas.count(salida)) {
+                borrados += fs::remove(salida);
+            }
+        }
+        cache = nullptr;
+        double tiempo = cronometro.milisegundos();
 
-    for (int i = 0; i < THREADS; ++i) {
-        pthread_join(threads[i], NULL);
+        cout << "Resaltados: " << cola.archivos.size() - omitidos << ", sin cambios: " << omitidos << ", borrados: " << borrados << endl;
+        cout << "Tiempo de ejecucion incremental (" << hilos << " hilos): " << tiempo << " ms" << endl;
+        return 0;
     }
-    double tiempoParalelo = stop_timer();
-    cout << "Tiempo de ejecucion paralelo: " << tiempoParalelo << " ms" << endl;
+
+    // Inicio de la ejecución paralela; el detalle por hilo se imprime solo en la última corrida
+    Reporte reporte("resaltador");
+    reporte.dato("archivos", archivos.size());
+    reporte.dato("hilos", hilos);
+    reporte.dato("compacto", salidaCompacta ? "si" : "no");
+    reporte.dato("escritura_asincrona", escrituraAsincrona ? "si" : "no");
+    vector<double> latencias;
+    int corrida = 0;
+    vector<double> tiemposParalelo = repetir(warmup, repeticiones, [&] {
+        bool ultima = ++corrida == warmup + repeticiones;
+        ColaArchivos cola(archivos);
+        resaltarEnParalelo(cola, directorioSalida, hilos, ultima && formato == TEXTO, corrida > warmup ? &latencias : nullptr);
+    });
+    reporte.agregar("paralelo", tiemposParalelo);
+    reporte.agregar("archivo_paralelo", latencias);
 
     // Limpieza de archivos generados por ejecución paralela
-        for (auto &p : fs::recursive_directory_iterator(directorioSalida)) {
+    for (auto &p : fs::recursive_directory_iterator(directorioSalida)) {
         if (fs::is_regular_file(p) && p.path().extension() == ".html") {
             fs::remove(p);
         }
     }
 
     // Inicio de la ejecución secuencial
-    start_timer();
+    hilosPorArchivo = 1;
+    vector<double> tiemposSecuencial = repetir(warmup, repeticiones, [&] {
+        for (auto& archivo : archivos) {
+            resaltarLexico(archivo, directorioSalida);
+        }
+    });
+    reporte.agregar("secuencial", tiemposSecuencial);
+    reporte.comparar("secuencial", "paralelo");
+    reporte.dato("memoria_maxima_kb", memoriaMaxima());
 
-    for (auto& archivo : archivos) {
-        resaltarLexico(archivo, directorioSalida);
+    if (formato != TEXTO) {
+        reporte.escribir(cout, formato);
+        return 0;
     }
-
-    double tiempoSecuencial = stop_timer();
-    cout << "Tiempo de ejecucion secuencial: " << tiempoSecuencial << " ms" << endl;
-
-    double speedup = tiempoSecuencial / tiempoParalelo;
-    cout << "Speedup: " << speedup << endl;
+    if (repeticiones > 1) {
+        cout << "Mediana paralela de " << repeticiones << " repeticiones: " << reporte.estadisticas("paralelo").mediana << " ms" << endl;
+    }
+    cout << "Tiempo de ejecucion secuencial: " << reporte.estadisticas("secuencial").mediana << " ms" << endl;
+    cout << "Speedup: " << reporte.speedup("secuencial", "paralelo") << endl;
+    cout << "Memoria residente maxima: " << memoriaMaxima() << " KB" << endl;
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,563 @@
+// ===========================================================================================
+// File: resaltador.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene el analizador léxico de C# basado en tablas que usa el
+//              resaltador. Recorre el texto una sola vez y reconoce los mismos tokens que
+//              la expresión regular original (ver resaltador_regex.h), sin construir objetos
+//              regex ni reservar memoria por token. Los espacios, comentarios y strings se
+//              recorren por bloques con SIMD (escaner_simd.h). Los archivos muy grandes también
+//              se pueden dividir en fragmentos que se analizan en paralelo.
+// ===========================================================================================
+#ifndef RESALTADOR_H
+#define RESALTADOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <pthread.h>
+#include "escaner_simd.h"
+
+// Versión del analizador y del HTML que genera. Se debe incrementar cada vez que cambie la salida,
+// para que el modo incremental no reutilice documentos generados con una versión anterior.
+const int VERSION_ANALIZADOR = 1;
+
+// Categorías léxicas que puede producir el analizador. Los caracteres '(' y ')' se
+// clasifican como separadores y '|' y '!' como operadores, así que la categoría
+// "Especial" del resaltador original nunca llega a emitirse.
+enum Categoria : uint8_t {
+    NINGUNA,        // Espacios en blanco (se emiten con class="")
+    SALTO_LINEA,    // Un "\n" aislado, se emite como </pre><pre>
+    COMENTARIO,
+    KEYWORD,
+    SYSTEM,
+    SEPARADOR,
+    STRING,
+    VARIABLE,
+    OPERADOR,
+    REAL
+};
+
+// Nombre de la clase CSS de cada categoría, en el mismo orden que el enum
+const std::string_view NOMBRES_CATEGORIA[] = {
+    "", "", "Comentario", "Keyword", "System", "Separators", "String", "Variable", "Operador", "Real"
+};
+
+// Encabezado y cierre del documento HTML generado
+const std::string_view ENCABEZADO_HTML =
+    "<style>"
+    ".Variable { color: blue; }"
+    ".Real { color: green; }"
+    ".Comentario { color: gray; }"
+    ".Especial { color: red; }"
+    ".Operador { color: purple; }"
+    ".Keyword { color: cyan; }"
+    ".body { backgroud-color: black;   }"
+    ".System { color: orange; }" // color para las palabras clave del sistema
+    ".Separators { color: red; }"
+    ".String { color: pink; }"
+    "</style>"
+    "<pre>";
+const std::string_view CIERRE_HTML = "</pre>";
+
+// Una palabra que no es una variable común: las palabras reservadas de C# y los identificadores del sistema
+struct PalabraReservada {
+    std::string_view nombre;
+    Categoria categoria;
+};
+
+// Las palabras de las alternativas keyword y system de la expresión original; de aquí sale la tabla hash
+constexpr std::array<PalabraReservada, 81> PALABRAS_RESERVADAS = {{
+    {"abstract", KEYWORD}, {"as", KEYWORD}, {"base", KEYWORD}, {"bool", KEYWORD}, {"break", KEYWORD},
+    {"byte", KEYWORD}, {"case", KEYWORD}, {"catch", KEYWORD}, {"char", KEYWORD}, {"checked", KEYWORD},
+    {"class", KEYWORD}, {"const", KEYWORD}, {"continue", KEYWORD}, {"decimal", KEYWORD}, {"default", KEYWORD},
+    {"delegate", KEYWORD}, {"do", KEYWORD}, {"double", KEYWORD}, {"else", KEYWORD}, {"enum", KEYWORD},
+    {"event", KEYWORD}, {"explicit", KEYWORD}, {"extern", KEYWORD}, {"false", KEYWORD}, {"finally", KEYWORD},
+    {"fixed", KEYWORD}, {"float", KEYWORD}, {"for", KEYWORD}, {"foreach", KEYWORD}, {"goto", KEYWORD},
+    {"if", KEYWORD}, {"implicit", KEYWORD}, {"in", KEYWORD}, {"int", KEYWORD}, {"interface", KEYWORD},
+    {"internal", KEYWORD}, {"is", KEYWORD}, {"lock", KEYWORD}, {"long", KEYWORD}, {"namespace", KEYWORD},
+    {"new", KEYWORD}, {"null", KEYWORD}, {"object", KEYWORD}, {"operator", KEYWORD}, {"out", KEYWORD},
+    {"override", KEYWORD}, {"params", KEYWORD}, {"private", KEYWORD}, {"protected", KEYWORD}, {"public", KEYWORD},
+    {"readonly", KEYWORD}, {"ref", KEYWORD}, {"return", KEYWORD}, {"sbyte", KEYWORD}, {"sealed", KEYWORD},
+    {"short", KEYWORD}, {"sizeof", KEYWORD}, {"stackalloc", KEYWORD}, {"static", KEYWORD}, {"string", KEYWORD},
+    {"struct", KEYWORD}, {"switch", KEYWORD}, {"this", KEYWORD}, {"throw", KEYWORD}, {"true", KEYWORD},
+    {"try", KEYWORD}, {"typeof", KEYWORD}, {"uint", KEYWORD}, {"ulong", KEYWORD}, {"unchecked", KEYWORD},
+    {"unsafe", KEYWORD}, {"ushort", KEYWORD}, {"using", KEYWORD}, {"virtual", KEYWORD}, {"void", KEYWORD},
+    {"volatile", KEYWORD}, {"while", KEYWORD},
+    {"Console", SYSTEM}, {"Program", SYSTEM}, {"System", SYSTEM}, {"program", SYSTEM}
+}};
+
+// Una palabra más corta o más larga que todas las de la lista no necesita calcular el hash
+constexpr size_t LONGITUD_MINIMA_RESERVADA = [] {
+    size_t minima = PALABRAS_RESERVADAS[0].nombre.size();
+    for (const PalabraReservada& p : PALABRAS_RESERVADAS) minima = std::min(minima, p.nombre.size());
+    return minima;
+}();
+constexpr size_t LONGITUD_MAXIMA_RESERVADA = [] {
+    size_t maxima = 0;
+    for (const PalabraReservada& p : PALABRAS_RESERVADAS) maxima = std::max(maxima, p.nombre.size());
+    return maxima;
+}();
+static_assert(LONGITUD_MINIMA_RESERVADA >= 2, "hashPalabra lee las dos primeras y las dos últimas letras");
+
+constexpr int BITS_HASH_RESERVADAS = 9;
+constexpr uint8_t SIN_PALABRA = 0xFF;
+
+/*
+Hash de una palabra con al menos dos letras: junta en 32 bits las dos primeras y las dos últimas
+letras, les mezcla la longitud y toma los bits altos del producto por un multiplicador impar. No
+recorre la palabra completa; basta con esos cuatro bytes y la longitud para separar las 81 palabras.
+*/
+constexpr uint32_t hashPalabra(std::string_view palabra, uint32_t multiplicador) {
+    size_t n = palabra.size();
+    uint32_t clave = (uint32_t) (uint8_t) palabra[0] | (uint32_t) (uint8_t) palabra[1] << 8 |
+                     (uint32_t) (uint8_t) palabra[n - 2] << 16 | (uint32_t) (uint8_t) palabra[n - 1] << 24;
+    clave ^= (uint32_t) n * 0x9E3779B9u;
+    return (clave * multiplicador) >> (32 - BITS_HASH_RESERVADAS);
+}
+
+// Multiplicador impar número semilla (splitmix64)
+constexpr uint32_t multiplicadorHash(uint64_t semilla) {
+    uint64_t z = semilla + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (uint32_t) (z ^ (z >> 31)) | 1;
+}
+
+// Tabla hash perfecta: cada casilla tiene el índice de su palabra en PALABRAS_RESERVADAS o SIN_PALABRA
+struct TablaReservadas {
+    uint32_t multiplicador = 0;
+    std::array<uint8_t, 1 << BITS_HASH_RESERVADAS> casillas{};
+};
+
+/*
+Prueba multiplicadores hasta encontrar uno con el que ninguna palabra choca con otra. Se evalúa al
+compilar, así que la búsqueda no cuesta nada al ejecutar; si ninguno sirviera, el static_assert de
+abajo detiene la compilación.
+*/
+constexpr TablaReservadas construirTablaReservadas() {
+    for (uint64_t semilla = 0; semilla < 10000; semilla++) {
+        TablaReservadas tabla;
+        tabla.multiplicador = multiplicadorHash(semilla);
+        for (uint8_t& casilla : tabla.casillas) casilla = SIN_PALABRA;
+        bool choca = false;
+        for (size_t i = 0; i < PALABRAS_RESERVADAS.size() && !choca; i++) {
+            uint8_t& casilla = tabla.casillas[hashPalabra(PALABRAS_RESERVADAS[i].nombre, tabla.multiplicador)];
+            choca = casilla != SIN_PALABRA;
+            casilla = (uint8_t) i;
+        }
+        if (!choca) return tabla;
+    }
+    return TablaReservadas();
+}
+
+constexpr TablaReservadas TABLA_RESERVADAS = construirTablaReservadas();
+static_assert(TABLA_RESERVADAS.multiplicador != 0, "No se encontró una tabla hash perfecta para las palabras reservadas");
+
+// Clase de cada byte de entrada; es la tabla que guía las transiciones del analizador
+enum ClaseCaracter : uint8_t {
+    C_OTRO,         // Caracteres que ninguna categoría reconoce y se descartan
+    C_LETRA,
+    C_DIGITO,
+    C_GUION_BAJO,
+    C_ESPACIO,
+    C_DIAGONAL,
+    C_COMILLA,
+    C_MENOS,
+    C_SEPARADOR,
+    C_OPERADOR
+};
+
+constexpr std::array<uint8_t, 256> construirTablaClases() {
+    std::array<uint8_t, 256> tabla{};
+    for (int c = 'a'; c <= 'z'; c++) tabla[c] = C_LETRA;
+    for (int c = 'A'; c <= 'Z'; c++) tabla[c] = C_LETRA;
+    for (int c = '0'; c <= '9'; c++) tabla[c] = C_DIGITO;
+    tabla['_'] = C_GUION_BAJO;
+    for (char c : {' ', '\t', '\n', '\v', '\f', '\r'}) tabla[(uint8_t) c] = C_ESPACIO;
+    tabla['/'] = C_DIAGONAL;
+    tabla['"'] = C_COMILLA;
+    tabla['-'] = C_MENOS;
+    for (char c : {'(', ')', '{', '}', '[', ']', ';', ',', '.'}) tabla[(uint8_t) c] = C_SEPARADOR;
+    for (char c : {'+', '*', '%', '^', '&', '|', '~', '!', '=', '<', '>', '?', ':'}) tabla[(uint8_t) c] = C_OPERADOR;
+    return tabla;
+}
+
+constexpr std::array<uint8_t, 256> CLASES = construirTablaClases();
+
+inline uint8_t claseDe(char c) {
+    return CLASES[(uint8_t) c];
+}
+
+inline bool esPalabra(char c) {
+    uint8_t clase = claseDe(c);
+    return clase == C_LETRA || clase == C_DIGITO || clase == C_GUION_BAJO;
+}
+
+inline bool esDigito(char c) {
+    return claseDe(c) == C_DIGITO;
+}
+
+/*
+Clasifica un identificador igual que la cadena de regex_match del resaltador original: un hash y,
+si la casilla tiene palabra, una sola comparación contra ella.
+*/
+inline Categoria clasificarIdentificador(std::string_view palabra) {
+    if (palabra.size() < LONGITUD_MINIMA_RESERVADA || palabra.size() > LONGITUD_MAXIMA_RESERVADA) {
+        return VARIABLE;
+    }
+    uint8_t indice = TABLA_RESERVADAS.casillas[hashPalabra(palabra, TABLA_RESERVADAS.multiplicador)];
+    if (indice != SIN_PALABRA && PALABRAS_RESERVADAS[indice].nombre == palabra) {
+        return PALABRAS_RESERVADAS[indice].categoria;
+    }
+    return VARIABLE;
+}
+
+struct Token {
+    Categoria tipo;
+    size_t inicio;
+    size_t longitud;
+};
+
+/*
+Busca el siguiente token a partir de pos y lo deja en token. Sigue el mismo orden de prioridad
+que la alternancia original (keyword|comentarios|strings|variable|reales|especiales|operadores|
+separators|system|espacios|lineBreak): los caracteres que ninguna alternativa reconoce se saltan.
+Regresa false cuando se llega al final del texto sin encontrar otro token.
+*/
+inline bool siguienteToken(const char* texto, size_t n, size_t& pos, Token& token) {
+    while (pos < n) {
+        size_t inicio = pos;
+        size_t i = pos;
+
+        switch (claseDe(texto[i])) {
+            case C_LETRA:
+                // [a-zA-Z][a-zA-Z_0-9]*
+                while (++i < n && esPalabra(texto[i])) {}
+                token = {clasificarIdentificador(std::string_view(texto + inicio, i - inicio)), inicio, i - inicio};
+                pos = i;
+                return true;
+
+            case C_DIAGONAL:
+                if (i + 1 < n && texto[i + 1] == '/') {
+                    // //.*\n?  ('.' no reconoce ni '\n' ni '\r')
+                    i = escanerActual->buscarFinLinea(texto, n, i + 2);
+                    if (i < n && texto[i] == '\n') i++;
+                    token = {COMENTARIO, inicio, i - inicio};
+                } else {
+                    token = {OPERADOR, inicio, 1};
+                    i++;
+                }
+                pos = i;
+                return true;
+
+            case C_COMILLA: {
+                // ".*" es voraz: llega hasta la última comilla antes del fin de línea
+                i = escanerActual->buscarFinLinea(texto, n, inicio + 1);
+                size_t ultima = escanerActual->buscarUltimaComilla(texto, inicio + 1, i);
+                if (ultima == i) {
+                    pos = inicio + 1;  // Comilla sin cerrar: ninguna alternativa la reconoce
+                    continue;
+                }
+                token = {STRING, inicio, ultima + 1 - inicio};
+                pos = ultima + 1;
+                return true;
+            }
+
+            case C_MENOS:
+                // -*[0-9]+...  Si después de los guiones no hay dígito es el operador '-'
+                while (i < n && texto[i] == '-') i++;
+                if (i >= n || !esDigito(texto[i])) {
+                    token = {OPERADOR, inicio, 1};
+                    pos = inicio + 1;
+                    return true;
+                }
+                [[fallthrough]];
+
+            case C_DIGITO:
+                // [0-9]+(\.[0-9]+([E][-*][0-9]+)?)?
+                while (i < n && esDigito(texto[i])) i++;
+                if (i + 1 < n && texto[i] == '.' && esDigito(texto[i + 1])) {
+                    i++;
+                    while (i < n && esDigito(texto[i])) i++;
+                    if (i + 2 < n && texto[i] == 'E' && (texto[i + 1] == '-' || texto[i + 1] == '*') && esDigito(texto[i + 2])) {
+                        i += 2;
+                        while (i < n && esDigito(texto[i])) i++;
+                    }
+                }
+                token = {REAL, inicio, i - inicio};
+                pos = i;
+                return true;
+
+            case C_ESPACIO:
+                // \s+ ; un "\n" aislado es el único caso que llega a la alternativa lineBreak
+                i = escanerActual->saltarEspacios(texto, n, i + 1);
+                token = {(i - inicio == 1 && texto[inicio] == '\n') ? SALTO_LINEA : NINGUNA, inicio, i - inicio};
+                pos = i;
+                return true;
+
+            case C_SEPARADOR:
+                token = {SEPARADOR, inicio, 1};
+                pos = i + 1;
+                return true;
+
+            case C_OPERADOR:
+                token = {OPERADOR, inicio, 1};
+                pos = i + 1;
+                return true;
+
+            default:
+                pos++;  // '_' suelto, comilla simple, '#', bytes no ASCII, etc.
+                break;
+        }
+    }
+    return false;
+}
+
+// Etiqueta de apertura de cada categoría, ya armada para copiarla de un solo golpe
+const std::string_view APERTURAS[] = {
+    "<span class=\"\">", "", "<span class=\"Comentario\">", "<span class=\"Keyword\">",
+    "<span class=\"System\">", "<span class=\"Separators\">", "<span class=\"String\">",
+    "<span class=\"Variable\">", "<span class=\"Operador\">", "<span class=\"Real\">"
+};
+const std::string_view CIERRE_SPAN = "</span>";
+const std::string_view SALTO_HTML = "</pre><pre>";
+
+/*
+Búfer de salida del HTML. Las etiquetas y el texto de cada token se copian con memcpy sobre un
+solo bloque de memoria que se reserva con el tamaño esperado y se reutiliza entre archivos (cada
+hilo tiene el suyo), así que no se crean cadenas temporales por token.
+
+En modo compacto los espacios se emiten sin el <span class=""> vacío y los tokens consecutivos de
+la misma categoría comparten un solo <span>; el HTML se ve igual pero pesa mucho menos. Sin el
+modo compacto la salida es byte por byte la del resaltador original.
+*/
+class EmisorHTML {
+public:
+    explicit EmisorHTML(bool compacto = false) : compacto(compacto) {}
+
+    // Vacía el búfer (sin liberarlo) y se asegura de tener al menos capacidadEsperada bytes
+    void reiniciar(size_t capacidadEsperada) {
+        tamano = 0;
+        abierta = -1;
+        reservar(capacidadEsperada);
+    }
+
+    void agregar(std::string_view datos) {
+        reservar(tamano + datos.size());
+        memcpy(buffer.get() + tamano, datos.data(), datos.size());
+        tamano += datos.size();
+    }
+
+    void token(Categoria tipo, std::string_view texto) {
+        if (tipo == SALTO_LINEA) {
+            cerrarSpan();
+            agregar(SALTO_HTML);
+        } else if (!compacto) {
+            reservar(tamano + APERTURAS[tipo].size() + texto.size() + CIERRE_SPAN.size());
+            copiar(APERTURAS[tipo]);
+            copiar(texto);
+            copiar(CIERRE_SPAN);
+        } else if (tipo == NINGUNA) {
+            cerrarSpan();
+            agregar(texto);
+        } else {
+            if (abierta != tipo) {
+                cerrarSpan();
+                agregar(APERTURAS[tipo]);
+                abierta = tipo;
+            }
+            agregar(texto);
+        }
+    }
+
+    // Cierra el <span> que el modo compacto haya dejado abierto
+    void cerrarSpan() {
+        if (abierta >= 0) {
+            agregar(CIERRE_SPAN);
+            abierta = -1;
+        }
+    }
+
+    std::string_view vista() const {
+        return std::string_view(buffer.get(), tamano);
+    }
+
+    size_t size() const {
+        return tamano;
+    }
+
+    bool compacto;
+
+private:
+    void reservar(size_t necesario) {
+        if (necesario <= capacidad) return;
+        size_t nueva = std::max(necesario, 2 * capacidad);
+        std::unique_ptr<char[]> otro(new char[nueva]);
+        if (tamano > 0) memcpy(otro.get(), buffer.get(), tamano);
+        buffer = std::move(otro);
+        capacidad = nueva;
+    }
+
+    // Copia sin revisar la capacidad (ya reservada por quien llama)
+    void copiar(std::string_view datos) {
+        memcpy(buffer.get() + tamano, datos.data(), datos.size());
+        tamano += datos.size();
+    }
+
+    std::unique_ptr<char[]> buffer;
+    size_t tamano = 0;
+    size_t capacidad = 0;
+    int abierta = -1;
+};
+
+// Tamaño con el que conviene reservar el búfer. Con un <span> por token la salida ocupa unas ocho
+// veces la entrada; reservar de más no cuesta memoria residente porque las páginas que no se
+// escriben nunca se asignan, mientras que quedarse corto obliga a copiar todo el búfer
+inline size_t capacidadEsperada(size_t bytesEntrada) {
+    return ENCABEZADO_HTML.size() + bytesEntrada * 9 + CIERRE_HTML.size() + 64;
+}
+
+/*
+Emite el HTML de los tokens que empiezan antes de fin, comenzando en pos. Un token puede terminar
+después de fin (por ejemplo si fin cae dentro de un comentario); en ese caso pos queda después del
+token. Regresa el número de tokens emitidos.
+*/
+inline size_t resaltarTokens(const char* texto, size_t n, size_t& pos, size_t fin, EmisorHTML& emisor) {
+    size_t tokens = 0;
+    Token token;
+
+    while (pos < fin && siguienteToken(texto, n, pos, token)) {
+        if (token.inicio >= fin) {
+            // Solo se saltaron caracteres sin categoría; el token le toca al siguiente fragmento
+            pos = fin;
+            break;
+        }
+        tokens++;
+        emisor.token(token.tipo, std::string_view(texto + token.inicio, token.longitud));
+    }
+    emisor.cerrarSpan();
+    return tokens;
+}
+
+/*
+Genera el documento HTML resaltado del contenido y lo agrega al emisor. Sin el modo compacto
+produce exactamente los mismos bytes que la versión con expresiones regulares. Regresa el número
+de tokens reconocidos.
+*/
+inline size_t resaltarContenido(std::string_view contenido, EmisorHTML& emisor) {
+    size_t pos = 0;
+
+    emisor.agregar(ENCABEZADO_HTML);
+    size_t tokens = resaltarTokens(contenido.data(), contenido.size(), pos, contenido.size(), emisor);
+    emisor.agregar(CIERRE_HTML);
+    return tokens;
+}
+
+// Igual que la anterior, pero agrega el documento a una cadena
+inline size_t resaltarContenido(std::string_view contenido, std::string& resaltado, bool compacto = false) {
+    EmisorHTML emisor(compacto);
+    emisor.reiniciar(capacidadEsperada(contenido.size()));
+    size_t tokens = resaltarContenido(contenido, emisor);
+    resaltado += emisor.vista();
+    return tokens;
+}
+
+/*
+Pre-escaneo especulativo para dividir un archivo grande en partes. Busca, a partir de cada
+posición objetivo, un salto de línea seguido de un carácter que no sea espacio: ni los strings ni
+los comentarios cruzan líneas, así que ahí casi siempre empieza un token nuevo. Los cortes no se
+validan aquí; resaltarContenidoPorPartes revisa cada uno y corrige los que no sean válidos.
+*/
+inline std::vector<size_t> buscarCortes(std::string_view contenido, size_t partes) {
+    std::vector<size_t> cortes;
+    size_t n = contenido.size();
+    size_t desde = 1;
+
+    for (size_t k = 1; k < partes; k++) {
+        size_t i = std::max(desde, k * n / partes);
+        while (i < n && !(contenido[i - 1] == '\n' && claseDe(contenido[i]) != C_ESPACIO)) i++;
+        if (i >= n) break;
+        cortes.push_back(i);
+        desde = i + 1;
+    }
+    return cortes;
+}
+
+// Un fragmento del archivo que se analiza en su propio hilo
+struct Fragmento {
+    const char* texto;
+    size_t n;
+    size_t inicio, fin;
+    size_t final;       // Posición donde terminó realmente el último token emitido
+    size_t tokens;
+    EmisorHTML html;
+};
+
+inline void* resaltarFragmento(void* arg) {
+    Fragmento* fragmento = (Fragmento*) arg;
+    size_t pos = fragmento->inicio;
+    fragmento->html.reiniciar(capacidadEsperada(fragmento->fin - fragmento->inicio));
+    fragmento->tokens = resaltarTokens(fragmento->texto, fragmento->n, pos, fragmento->fin, fragmento->html);
+    fragmento->final = pos;
+    return nullptr;
+}
+
+/*
+Versión paralela de resaltarContenido: cada fragmento delimitado por cortes se analiza en su
+propio hilo y los pedazos de HTML se unen en orden; si no se puede crear el hilo de un fragmento,
+ese se analiza aquí mismo. Si el fragmento anterior terminó en una
+posición distinta al inicio del siguiente (el corte cayó dentro de un token), ese fragmento se
+vuelve a analizar secuencialmente desde donde quedó el anterior. Sin el modo compacto el
+resultado es idéntico al de resaltarContenido para cualquier conjunto de cortes.
+*/
+inline size_t resaltarContenidoPorPartes(std::string_view contenido, const std::vector<size_t>& cortes, EmisorHTML& emisor) {
+    size_t partes = cortes.size() + 1;
+    std::vector<Fragmento> fragmentos(partes);
+    std::vector<pthread_t> hilos(partes);
+    std::vector<bool> creados(partes, false);
+
+    for (size_t i = 0; i < partes; i++) {
+        fragmentos[i].texto = contenido.data();
+        fragmentos[i].n = contenido.size();
+        fragmentos[i].inicio = i == 0 ? 0 : cortes[i - 1];
+        fragmentos[i].fin = i == partes - 1 ? contenido.size() : cortes[i];
+        fragmentos[i].html.compacto = emisor.compacto;
+        creados[i] = pthread_create(&hilos[i], NULL, resaltarFragmento, &fragmentos[i]) == 0;
+        if (!creados[i]) resaltarFragmento(&fragmentos[i]);
+    }
+    for (size_t i = 0; i < partes; i++) {
+        if (creados[i]) pthread_join(hilos[i], NULL);
+    }
+
+    size_t tokens = 0;
+    size_t anterior = 0;
+    emisor.agregar(ENCABEZADO_HTML);
+    for (Fragmento& fragmento : fragmentos) {
+        if (anterior != fragmento.inicio) {
+            // Corte inválido: se descarta lo especulado y se continúa desde donde quedó el anterior
+            fragmento.html.reiniciar(0);
+            if (anterior < fragmento.fin) {
+                size_t pos = anterior;
+                fragmento.tokens = resaltarTokens(contenido.data(), contenido.size(), pos, fragmento.fin, fragmento.html);
+                fragmento.final = pos;
+            } else {
+                fragmento.tokens = 0;
+                fragmento.final = anterior;
+            }
+        }
+        emisor.agregar(fragmento.html.vista());
+        tokens += fragmento.tokens;
+        anterior = fragmento.final;
+    }
+    emisor.agregar(CIERRE_HTML);
+    return tokens;
+}
+
+#endif
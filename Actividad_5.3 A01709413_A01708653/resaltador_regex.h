@@ -0,0 +1,92 @@
+// ===========================================================================================
+// File: resaltador_regex.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Versión original del resaltador, basada en std::regex. Ya no la usa el
+//              programa principal; se conserva como referencia para comparar la salida y el
+//              rendimiento del analizador de resaltador.h.
+// ===========================================================================================
+#ifndef RESALTADOR_REGEX_H
+#define RESALTADOR_REGEX_H
+
+#include <regex>
+#include <string>
+
+// Las alternativas keyword y system, que también usa benchmark.cpp para comparar la clasificación de identificadores
+const char* const REGEX_KEYWORD = "\\b(abstract|as|base|bool|break|byte|case|catch|char|checked|class|const|continue|decimal|default|delegate|do|double|else|enum|event|explicit|extern|false|finally|fixed|float|for|foreach|goto|if|implicit|in|int|interface|internal|is|lock|long|namespace|new|null|object|operator|out|override|params|private|protected|public|readonly|ref|return|sbyte|sealed|short|sizeof|stackalloc|static|string|struct|switch|this|throw|true|try|typeof|uint|ulong|unchecked|unsafe|ushort|using|virtual|void|volatile|while)\\b";
+const char* const REGEX_SYSTEM = "\\b(System|Console|Program|program)\\b";
+
+/*
+Genera el HTML del contenido usando una expresión regular por categoría léxica, tal como lo
+hacía resaltarLexico originalmente. Regresa el número de tokens reconocidos.
+*/
+inline size_t resaltarContenidoRegex(const std::string& contenido, std::string& resaltado) {
+    using namespace std;
+
+    // Define las expresiones regulares
+    string comentarios = "//.*\n?";
+    string keyword = REGEX_KEYWORD;
+    string operadores = "\\+|-|\\*|/|%|\\^|&|\\||~|!|=|<|>|\\?|:|;|,|\\.|\\+\\+|--|&&|\\|\\||==|!=|<=|>=|\\+=|-=|\\*=|/=|%\\=|\\^=|&\\=|\\|=|<<=|>>=|=>|\\?\\?";
+    string reales = "-*[0-9]+\\.[0-9]+([E][-*][0-9]+)?|-*[0-9]+(\\.[0-9]+)?";
+    string especiales = "[\\(\\)|!]";
+    string espacios = "\\s+";
+    string variable = "[a-zA-Z][a-zA-Z_0-9]*";
+    string lineBreak = "\n";
+    string strings = "\".*\"";
+    string system = REGEX_SYSTEM;
+    string separators = "[\\(\\)\\{\\}\\[\\];,.]";
+
+    size_t tokens = 0;
+    resaltado += "<style>"
+                    ".Variable { color: blue; }"
+                    ".Real { color: green; }"
+                    ".Comentario { color: gray; }"
+                    ".Especial { color: red; }"
+                    ".Operador { color: purple; }"
+                    ".Keyword { color: cyan; }"
+                    ".body { backgroud-color: black;   }"
+                    ".System { color: orange; }" // color para las palabras clave del sistema
+                    ".Separators { color: red; }"
+                    ".String { color: pink; }"
+                    "</style>";
+    resaltado += "<pre>";
+    regex regex_tokens(keyword + "|" + comentarios + "|" + strings + "|" + variable + "|" + reales + "|" + especiales + "|" + operadores + "|" + separators + "|" + system + "|" + espacios + "|" + lineBreak);
+
+    for (sregex_iterator it(contenido.begin(), contenido.end(), regex_tokens); it != sregex_iterator(); ++it) {
+        string token = it->str();
+        string tipoToken;
+        tokens++;
+
+        if (regex_match(token, regex(lineBreak))) {
+            resaltado += "</pre><pre>";
+        } else if (regex_match(token, regex(comentarios))) {
+            tipoToken = "Comentario";
+        } else if (regex_match(token, regex(keyword))) {
+            tipoToken = "Keyword";
+        } else if (regex_match(token, regex(system))) {
+            tipoToken = "System";
+        } else if (regex_match(token, regex(separators))) {
+            tipoToken = "Separators";
+        } else if (regex_match(token, regex(strings))) {
+            tipoToken = "String";
+        } else if (regex_match(token, regex(variable))) {
+            tipoToken = "Variable";
+        } else if (regex_match(token, regex(operadores))) {
+            tipoToken = "Operador";
+        } else if (regex_match(token, regex(reales))) {
+            tipoToken = "Real";
+        } else if (regex_match(token, regex(especiales))) {
+            tipoToken = "Especial";
+        } else {
+            tipoToken = ""; // Espacios no deben ser resaltados
+        }
+
+        if (token != "\n") {
+            resaltado += "<span class=\"" + tipoToken + "\">" + token + "</span>";
+        }
+    }
+    resaltado += "</pre>";
+    return tokens;
+}
+
+#endif
@@ -0,0 +1,184 @@
+// ===========================================================================================
+// File: vigilancia.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Este archivo contiene el modo de vigilancia del resaltador: observa un
+//              directorio con inotify, agrupa las ráfagas de eventos que produce un guardado
+//              y reporta la latencia entre el evento y el HTML actualizado en un histograma.
+//              Si la cola de eventos del kernel se desborda se vuelve a recorrer todo el árbol.
+// ===========================================================================================
+#ifndef VIGILANCIA_H
+#define VIGILANCIA_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <filesystem>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+/*
+Histograma de latencias con cubetas en potencias de dos de microsegundos: la cubeta i cuenta las
+latencias en [2^(i-1), 2^i) us. Registrar es O(1) y no reserva memoria.
+*/
+class HistogramaLatencia {
+public:
+    void registrar(double microsegundos) {
+        size_t i = 0;
+        while (i + 1 < cubetas.size() && (double) (1ULL << i) <= microsegundos) i++;
+        cubetas[i]++;
+        total++;
+        suma += microsegundos;
+        if (microsegundos > maximo) maximo = microsegundos;
+    }
+
+    // Límite superior (en us) de la cubeta donde cae el percentil p
+    double percentil(double p) const {
+        uint64_t objetivo = (uint64_t) (p * total);
+        uint64_t acumulado = 0;
+        for (size_t i = 0; i < cubetas.size(); i++) {
+            acumulado += cubetas[i];
+            if (acumulado > objetivo) return (double) (1ULL << i);
+        }
+        return maximo;
+    }
+
+    void imprimir(std::ostream& salida) const {
+        salida << "Latencia evento -> HTML (" << total << " archivos)" << std::endl;
+        if (total == 0) return;
+        for (size_t i = 0; i < cubetas.size(); i++) {
+            if (cubetas[i] == 0) continue;
+            double desde = i == 0 ? 0 : (double) (1ULL << (i - 1)) / 1000.0;
+            double hasta = (double) (1ULL << i) / 1000.0;
+            salida << "  [" << desde << ", " << hasta << ") ms: " << cubetas[i] << std::endl;
+        }
+        salida << "  promedio " << suma / total / 1000.0 << " ms, p50 < " << percentil(0.50) / 1000.0
+               << " ms, p99 < " << percentil(0.99) / 1000.0 << " ms, max " << maximo / 1000.0 << " ms" << std::endl;
+    }
+
+private:
+    std::array<uint64_t, 36> cubetas{};
+    uint64_t total = 0;
+    double suma = 0;
+    double maximo = 0;
+};
+
+// Archivos tocados y el momento en que llegó el primer evento de cada uno
+typedef std::unordered_map<std::string, std::chrono::steady_clock::time_point> ArchivosTocados;
+
+/*
+Observa un directorio (y sus subdirectorios) con inotify y reporta los archivos .cs que se
+escribieron, crearon o movieron hacia él.
+*/
+class Vigilante {
+public:
+    ~Vigilante() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool iniciar(const std::string& directorio) {
+        fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+        if (fd < 0) {
+            std::cerr << "Error al iniciar inotify" << std::endl;
+            return false;
+        }
+        raiz = directorio;
+        return observar(directorio, nullptr);
+    }
+
+    /*
+    Espera a que llegue al menos un evento y luego sigue juntando eventos hasta que pasen silencioMs
+    sin ninguno nuevo (o maximoMs desde el primero), para que un guardado que produce varios eventos
+    se procese una sola vez. Regresa false si la espera se interrumpió con una señal.
+    */
+    bool esperarCambios(int silencioMs, int maximoMs, ArchivosTocados& tocados) {
+        tocados.clear();
+        if (!esperar(-1)) return false;
+        auto primero = std::chrono::steady_clock::now();
+        leerEventos(tocados);
+
+        while (true) {
+            auto transcurrido = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - primero).count();
+            int restante = std::min<long>(silencioMs, maximoMs - transcurrido);
+            if (restante <= 0 || !esperar(restante)) break;
+            leerEventos(tocados);
+        }
+        return true;
+    }
+
+private:
+    /*
+    Observa directorio y sus subdirectorios. Si se da tocados (un directorio que apareció mientras se
+    vigilaba, o todo el árbol después de un desbordamiento), los .cs que ya tiene se agregan ahí: se
+    pudieron escribir sin que llegara su evento. Volver a observar un directorio conserva su wd.
+    */
+    bool observar(const std::string& directorio, ArchivosTocados* tocados) {
+        int wd = inotify_add_watch(fd, directorio.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF);
+        if (wd < 0) {
+            std::cerr << "Error al observar el directorio: " << directorio << std::endl;
+            return false;
+        }
+        directorios[wd] = directorio;
+        auto ahora = std::chrono::steady_clock::now();
+        std::error_code error;      // El directorio pudo borrarse mientras se recorría
+        for (auto &p : std::filesystem::directory_iterator(directorio, error)) {
+            if (p.is_directory(error)) {
+                observar(p.path().string(), tocados);
+            } else if (tocados && p.is_regular_file(error) && p.path().extension() == ".cs") {
+                tocados->emplace(p.path().string(), ahora);
+            }
+        }
+        return true;
+    }
+
+    // Espera hasta timeoutMs a que haya eventos; false si se agotó el tiempo o llegó una señal
+    bool esperar(int timeoutMs) {
+        pollfd pfd = {fd, POLLIN, 0};
+        return poll(&pfd, 1, timeoutMs) > 0;
+    }
+
+    /*
+    Los eventos sin nombre son del propio directorio: IN_Q_OVERFLOW dice que el kernel descartó eventos,
+    así que se recorre de nuevo todo el árbol; IN_DELETE_SELF e IN_IGNORED dicen que el observador ya
+    no existe y su wd se puede reutilizar para otro directorio.
+    */
+    void leerEventos(ArchivosTocados& tocados) {
+        alignas(inotify_event) char buffer[1 << 16];
+        ssize_t leidos;
+        while ((leidos = read(fd, buffer, sizeof(buffer))) > 0) {
+            auto ahora = std::chrono::steady_clock::now();
+            for (char* p = buffer; p < buffer + leidos; p += sizeof(inotify_event) + ((inotify_event*) p)->len) {
+                inotify_event* evento = (inotify_event*) p;
+                if (evento->mask & IN_Q_OVERFLOW) {
+                    std::cerr << "Se perdieron eventos de inotify; se revisa todo " << raiz << std::endl;
+                    observar(raiz, &tocados);
+                    continue;
+                }
+                if (evento->mask & (IN_DELETE_SELF | IN_IGNORED)) {
+                    directorios.erase(evento->wd);
+                    continue;
+                }
+                auto directorio = directorios.find(evento->wd);
+                if (evento->len == 0 || directorio == directorios.end()) continue;
+                std::string ruta = directorio->second + "/" + evento->name;
+                if (evento->mask & IN_ISDIR) {
+                    if (evento->mask & (IN_CREATE | IN_MOVED_TO)) observar(ruta, &tocados);
+                } else if (std::filesystem::path(ruta).extension() == ".cs" && (evento->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) {
+                    tocados.emplace(ruta, ahora);   // Se conserva el primer evento de la ráfaga
+                }
+            }
+        }
+    }
+
+    int fd = -1;
+    std::string raiz;
+    std::unordered_map<int, std::string> directorios;
+};
+
+#endif
@@ -0,0 +1,321 @@
+// ===========================================================================================
+// File: perfilador.h
+// Author: María Fernanda Moreno Gómez A01708653
+//         Uri Jared Gopar Morales  A01709413
+// Description: Biblioteca de medición compartida por las actividades (solo encabezado).
+//              Tiene cronómetros sobre steady_clock y el contador de ciclos del procesador,
+//              mediciones con alcance (RAII), vueltas por hilo, repeticiones con
+//              calentamiento, estadísticas robustas (mediana, MAD, p99, intervalo de
+//              confianza de la mediana) y reportes en JSON o CSV con el speedup entre
+//              mediciones. Reemplaza al utils.h que cada actividad copiaba: ese temporizador
+//              era global, de un solo uso y no se podía usar desde varios hilos.
+// ===========================================================================================
+#ifndef PERFILADOR_H
+#define PERFILADOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Ciclos del contador de tiempo del procesador (rdtsc); en otras arquitecturas, nanosegundos
+inline uint64_t leerCiclos() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*
+Cronómetro monótono: empieza al construirse y se puede consultar o reiniciar cuantas veces se quiera.
+Cada quien tiene el suyo, así que se puede usar desde varios hilos a la vez.
+*/
+class Cronometro {
+public:
+    Cronometro() : inicio(std::chrono::steady_clock::now()), ciclosInicio(leerCiclos()) {}
+
+    void reiniciar() {
+        inicio = std::chrono::steady_clock::now();
+        ciclosInicio = leerCiclos();
+    }
+
+    double milisegundos() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    }
+
+    double microsegundos() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - inicio).count();
+    }
+
+    uint64_t ciclos() const {
+        return leerCiclos() - ciclosInicio;
+    }
+
+private:
+    std::chrono::steady_clock::time_point inicio;
+    uint64_t ciclosInicio;
+};
+
+// Al salir de su alcance agrega los ms transcurridos al final de destino
+class MedicionAlcance {
+public:
+    explicit MedicionAlcance(std::vector<double>& destino) : destino(destino) {}
+    MedicionAlcance(const MedicionAlcance&) = delete;
+    MedicionAlcance& operator=(const MedicionAlcance&) = delete;
+
+    ~MedicionAlcance() {
+        destino.push_back(cronometro.milisegundos());
+    }
+
+private:
+    std::vector<double>& destino;
+    Cronometro cronometro;
+};
+
+/*
+Vueltas (tiempos de cada unidad de trabajo) de cada hilo. Cada hilo escribe solo en su propia lista,
+que ocupa su propia línea de caché, así que no hace falta ningún candado para registrar.
+*/
+class VueltasPorHilo {
+public:
+    explicit VueltasPorHilo(int hilos) : listas(hilos) {}
+
+    void registrar(int hilo, double valor) {
+        listas[hilo].valores.push_back(valor);
+    }
+
+    const std::vector<double>& de(int hilo) const {
+        return listas[hilo].valores;
+    }
+
+    double total(int hilo) const {
+        double suma = 0;
+        for (double valor : listas[hilo].valores) suma += valor;
+        return suma;
+    }
+
+    // Las vueltas de todos los hilos juntas
+    std::vector<double> todas() const {
+        std::vector<double> valores;
+        for (const Lista& lista : listas) valores.insert(valores.end(), lista.valores.begin(), lista.valores.end());
+        return valores;
+    }
+
+private:
+    struct alignas(64) Lista {
+        std::vector<double> valores;
+    };
+    std::vector<Lista> listas;
+};
+
+struct Estadisticas {
+    size_t muestras = 0;
+    double minimo = 0, maximo = 0, media = 0;
+    double mediana = 0;
+    double mad = 0;                     // Mediana de las desviaciones absolutas respecto a la mediana
+    double p99 = 0;
+    double icInferior = 0, icSuperior = 0;     // Intervalo de confianza del 95% de la mediana
+};
+
+// Percentil por rango más cercano de un arreglo ya ordenado
+inline double percentil(const std::vector<double>& ordenado, double p) {
+    if (ordenado.empty()) return 0;
+    size_t i = (size_t) (p * (ordenado.size() - 1) + 0.5);
+    return ordenado[std::min(i, ordenado.size() - 1)];
+}
+
+inline double medianaOrdenada(const std::vector<double>& ordenado) {
+    size_t n = ordenado.size();
+    if (n == 0) return 0;
+    return n % 2 ? ordenado[n / 2] : (ordenado[n / 2 - 1] + ordenado[n / 2]) / 2;
+}
+
+/*
+Estadísticas de un conjunto de muestras. La mediana y el MAD no se mueven con unas cuantas corridas
+atípicas (una interrupción del sistema, un fallo de página) como la media y la desviación estándar.
+El intervalo de la mediana sale de los estadísticos de orden n/2 ± 1.96·sqrt(n)/2, así que no supone
+ninguna distribución; con pocas muestras es simplemente [mínimo, máximo].
+*/
+inline Estadisticas calcularEstadisticas(std::vector<double> valores) {
+    Estadisticas e;
+    if (valores.empty()) return e;
+    std::sort(valores.begin(), valores.end());
+    size_t n = valores.size();
+    e.muestras = n;
+    e.minimo = valores.front();
+    e.maximo = valores.back();
+    for (double valor : valores) e.media += valor;
+    e.media /= n;
+    e.mediana = medianaOrdenada(valores);
+    e.p99 = percentil(valores, 0.99);
+
+    std::vector<double> desviaciones(n);
+    for (size_t i = 0; i < n; i++) desviaciones[i] = std::fabs(valores[i] - e.mediana);
+    std::sort(desviaciones.begin(), desviaciones.end());
+    e.mad = medianaOrdenada(desviaciones);
+
+    double radio = 1.96 * std::sqrt((double) n) / 2;
+    long inferior = (long) std::floor(n / 2.0 - radio);
+    long superior = (long) std::ceil(n / 2.0 + radio);
+    e.icInferior = valores[std::max(0L, inferior)];
+    e.icSuperior = valores[std::min((long) n - 1, superior)];
+    return e;
+}
+
+/*
+Corre funcion() warmup veces sin medir (cachés, páginas y predictores se calientan) y después
+repeticiones veces midiendo cada una. Regresa los ms de cada repetición medida.
+*/
+template <typename Funcion>
+std::vector<double> repetir(int warmup, int repeticiones, Funcion funcion) {
+    for (int i = 0; i < warmup; i++) {
+        funcion();
+    }
+    std::vector<double> tiempos;
+    for (int i = 0; i < repeticiones; i++) {
+        MedicionAlcance medicion(tiempos);
+        funcion();
+    }
+    return tiempos;
+}
+
+enum FormatoReporte { TEXTO, JSON, CSV };
+
+inline bool leerFormato(const std::string& nombre, FormatoReporte& formato) {
+    const char* nombres[] = {"texto", "json", "csv"};
+    for (int i = 0; i < 3; i++) {
+        if (nombre == nombres[i]) {
+            formato = (FormatoReporte) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+Reporte de un programa: datos generales (clave y valor), las estadísticas de cada medición en ms y
+comparaciones entre mediciones, cuyo speedup es la mediana de la base entre la mediana de la otra.
+*/
+class Reporte {
+public:
+    explicit Reporte(const std::string& programa) : programa(programa) {}
+
+    void dato(const std::string& clave, const std::string& valor) {
+        datos.push_back({clave, "\"" + escapar(valor) + "\""});
+    }
+
+    void dato(const std::string& clave, double valor) {
+        datos.push_back({clave, numero(valor)});
+    }
+
+    void agregar(const std::string& nombre, const std::vector<double>& muestrasMs) {
+        mediciones.push_back({nombre, calcularEstadisticas(muestrasMs)});
+    }
+
+    void comparar(const std::string& base, const std::string& otra) {
+        comparaciones.push_back({base, otra});
+    }
+
+    const Estadisticas& estadisticas(const std::string& nombre) const {
+        static const Estadisticas vacia;
+        for (const Medicion& m : mediciones) {
+            if (m.nombre == nombre) return m.estadisticas;
+        }
+        return vacia;
+    }
+
+    double speedup(const std::string& base, const std::string& otra) const {
+        double denominador = estadisticas(otra).mediana;
+        return denominador > 0 ? estadisticas(base).mediana / denominador : 0;
+    }
+
+    void escribir(std::ostream& salida, FormatoReporte formato) const {
+        if (formato == JSON) escribirJSON(salida);
+        if (formato == CSV) escribirCSV(salida);
+    }
+
+    void escribirJSON(std::ostream& salida) const {
+        salida << "{\n  \"programa\": \"" << escapar(programa) << "\"";
+        for (const std::pair<std::string, std::string>& d : datos) {
+            salida << ",\n  \"" << escapar(d.first) << "\": " << d.second;
+        }
+        salida << ",\n  \"mediciones\": [";
+        for (size_t i = 0; i < mediciones.size(); i++) {
+            const Estadisticas& e = mediciones[i].estadisticas;
+            salida << (i ? ",\n" : "\n") << "    {\"nombre\": \"" << escapar(mediciones[i].nombre) << "\", \"muestras\": " << e.muestras
+                   << ", \"mediana_ms\": " << numero(e.mediana) << ", \"mad_ms\": " << numero(e.mad)
+                   << ", \"media_ms\": " << numero(e.media) << ", \"min_ms\": " << numero(e.minimo)
+                   << ", \"max_ms\": " << numero(e.maximo) << ", \"p99_ms\": " << numero(e.p99)
+                   << ", \"ic95_ms\": [" << numero(e.icInferior) << ", " << numero(e.icSuperior) << "]}";
+        }
+        salida << "\n  ],\n  \"speedup\": [";
+        for (size_t i = 0; i < comparaciones.size(); i++) {
+            const std::pair<std::string, std::string>& c = comparaciones[i];
+            salida << (i ? ",\n" : "\n") << "    {\"base\": \"" << escapar(c.first) << "\", \"contra\": \"" << escapar(c.second)
+                   << "\", \"speedup\": " << numero(speedup(c.first, c.second)) << "}";
+        }
+        salida << "\n  ]\n}" << std::endl;
+    }
+
+    // Una fila por medición; los datos generales y el speedup contra la base van en cada fila
+    void escribirCSV(std::ostream& salida) const {
+        salida << "programa,nombre,muestras,mediana_ms,mad_ms,media_ms,min_ms,max_ms,p99_ms,ic95_inferior_ms,ic95_superior_ms,speedup";
+        for (const std::pair<std::string, std::string>& d : datos) salida << "," << d.first;
+        salida << "\n";
+        for (const Medicion& m : mediciones) {
+            const Estadisticas& e = m.estadisticas;
+            double s = 0;
+            for (const std::pair<std::string, std::string>& c : comparaciones) {
+                if (c.second == m.nombre) s = speedup(c.first, c.second);
+            }
+            salida << programa << "," << m.nombre << "," << e.muestras << "," << numero(e.mediana) << "," << numero(e.mad)
+                   << "," << numero(e.media) << "," << numero(e.minimo) << "," << numero(e.maximo) << "," << numero(e.p99)
+                   << "," << numero(e.icInferior) << "," << numero(e.icSuperior) << "," << (s > 0 ? numero(s) : "");
+            for (const std::pair<std::string, std::string>& d : datos) salida << "," << d.second;
+            salida << "\n";
+        }
+        salida.flush();
+    }
+
+private:
+    struct Medicion {
+        std::string nombre;
+        Estadisticas estadisticas;
+    };
+
+    static std::string escapar(const std::string& texto) {
+        std::string resultado;
+        for (char c : texto) {
+            if (c == '"' || c == '\\') resultado += '\\';
+            resultado += c;
+        }
+        return resultado;
+    }
+
+    // Los enteros se escriben completos (un tamaño de bloque no debe salir como 4.1943e+06)
+    static std::string numero(double valor) {
+        char texto[32];
+        if (valor == std::floor(valor) && std::fabs(valor) < 1e15) {
+            snprintf(texto, sizeof(texto), "%.0f", valor);
+        } else {
+            snprintf(texto, sizeof(texto), "%.6g", valor);
+        }
+        return texto;
+    }
+
+    std::string programa;
+    std::vector<std::pair<std::string, std::string>> datos;
+    std::vector<Medicion> mediciones;
+    std::vector<std::pair<std::string, std::string>> comparaciones;
+};
+
+#endif